@@ -0,0 +1,148 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeAnalyzer
+// Class:      MVACutMap
+//
+/**\class MVACutMap MVACutMap.h VertexCompositeAnalysis/VertexCompositeAnalyzer/plugins/MVACutMap.h
+
+ Description: binned MVA cut lookup in (y, pT, centrality, multiplicity)
+              without ROOT calls per candidate
+
+ Implementation:
+     The bin edges and contents of a TH1/TH2/TH3 are copied at
+     construction, including ROOT's under- and overflow bins, into flat
+     arrays indexed like the histogram global bins. Each histogram axis is
+     mapped onto one of the candidate variables. Uniform axes find the bin
+     with the same arithmetic as TAxis::FindFixBin, variable ones by
+     bisection of the edges, so the values agree with GetBinContent.
+
+     Variables can be clamped before the lookup, and a range can be set
+     outside of which the default cut is returned. Axes that are not
+     binned are ignored by the lookup.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__MVA_CUT_MAP_H
+#define VertexCompositeAnalysis__MVA_CUT_MAP_H
+
+#include <TH1.h>
+#include <TAxis.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+class MVACutMap {
+ public:
+  enum Axis { kY = 0, kPt, kCentrality, kMultiplicity, kNAxes };
+
+  explicit MVACutMap(double defaultCut = -1.0) : theDefault(defaultCut) {
+    const double inf = std::numeric_limits<double>::infinity();
+    for(unsigned int axis = 0; axis < kNAxes; axis++) {
+      theClampMin[axis] = -inf;
+      theClampMax[axis] = inf;
+      theRangeMin[axis] = -inf;
+      theRangeMax[axis] = inf;
+    }
+  }
+
+  // axes[i] is the variable on the i-th histogram axis (x, y, z)
+  void build(const TH1& hist, const std::vector<Axis>& axes) {
+    const TAxis* histAxes[3] = {hist.GetXaxis(), hist.GetYaxis(), hist.GetZaxis()};
+    theBinnedAxes.clear();
+    int stride = 1;
+    for(unsigned int i = 0; i < axes.size() && i < 3; i++) {
+      const TAxis& histAxis = *histAxes[i];
+      BinnedAxis binned;
+      binned.axis = axes[i];
+      binned.nBins = histAxis.GetNbins();
+      binned.min = histAxis.GetXmin();
+      binned.max = histAxis.GetXmax();
+      if( histAxis.GetXbins()->GetSize() ) {
+        binned.edges.assign(histAxis.GetXbins()->GetArray(), histAxis.GetXbins()->GetArray() + histAxis.GetXbins()->GetSize());
+      }
+      binned.stride = stride;
+      stride *= binned.nBins + 2;
+      theBinnedAxes.push_back(binned);
+    }
+
+    theValues.resize(stride);
+    for(int bin = 0; bin < stride; bin++) theValues[bin] = hist.GetBinContent(bin);
+  }
+
+  // The variable is moved into [min, max] before the bin lookup
+  void setClamp(Axis axis, double min, double max) {
+    theClampMin[axis] = min;
+    theClampMax[axis] = max;
+  }
+
+  // Outside [min, max] the default cut is returned
+  void setRange(Axis axis, double min, double max) {
+    theRangeMin[axis] = min;
+    theRangeMax[axis] = max;
+  }
+
+  bool isValid() const { return !theValues.empty(); }
+
+  // point holds the kNAxes variables of one candidate, in Axis order
+  double cut(const double* point) const {
+    for(unsigned int axis = 0; axis < kNAxes; axis++) {
+      if( point[axis] < theRangeMin[axis] || point[axis] > theRangeMax[axis] ) return theDefault;
+    }
+    if( !isValid() ) return theDefault;
+
+    int bin = 0;
+    for(unsigned int i = 0; i < theBinnedAxes.size(); i++) {
+      const BinnedAxis& binned = theBinnedAxes[i];
+      double x = point[binned.axis];
+      if( x > theClampMax[binned.axis] ) x = theClampMax[binned.axis];
+      if( x < theClampMin[binned.axis] ) x = theClampMin[binned.axis];
+      bin += binned.stride * binned.find(x);
+    }
+    return theValues[bin];
+  }
+
+  // columns[axis] holds the variable of every candidate, values gets one
+  //  cut per candidate. Columns of unused axes may be left empty.
+  void cuts(const std::vector<double>* columns, std::vector<double>& values) const {
+    unsigned int n = 0;
+    for(unsigned int axis = 0; axis < kNAxes; axis++) n = std::max(n, (unsigned int)columns[axis].size());
+    values.resize(n);
+
+    double point[kNAxes];
+    for(unsigned int k = 0; k < n; k++) {
+      for(unsigned int axis = 0; axis < kNAxes; axis++) point[axis] = columns[axis].empty() ? 0. : columns[axis][k];
+      values[k] = cut(point);
+    }
+  }
+
+ private:
+  struct BinnedAxis {
+    Axis axis;
+    int nBins;
+    double min;
+    double max;
+    std::vector<double> edges;   // empty for uniform bins
+    int stride;
+
+    // Same as TAxis::FindFixBin, 0 and nBins+1 are under- and overflow
+    int find(double x) const {
+      if( x < min ) return 0;
+      if( !(x < max) ) return nBins+1;
+      if( edges.empty() ) return 1 + int(nBins*(x-min)/(max-min));
+      return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+    }
+  };
+
+  double theDefault;
+  double theClampMin[kNAxes];
+  double theClampMax[kNAxes];
+  double theRangeMin[kNAxes];
+  double theRangeMax[kNAxes];
+
+  std::vector<BinnedAxis> theBinnedAxes;
+  std::vector<double> theValues;
+};
+
+#endif
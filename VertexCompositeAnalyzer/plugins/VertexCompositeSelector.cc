@@ -30,6 +30,7 @@
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 #include "FWCore/Framework/interface/EDProducer.h"
 #include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
 
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
@@ -66,6 +67,9 @@
 
 #include "CondFormats/DataRecord/interface/GBRWrapperRcd.h"
 #include "CondFormats/EgammaObjects/interface/GBRForest.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/FlatGBRForest.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/CompiledGBRForest.h"
+#include "VertexCompositeAnalysis/VertexCompositeAnalyzer/plugins/MVACutMap.h"
 
 #include <Math/Functions.h>
 #include <Math/SVector.h>
@@ -94,6 +98,7 @@ private:
   virtual void endJob() ;
 
   double GetMVACut(double y, double pt);
+  void selectByMVA(const reco::VertexCompositeCandidateCollection& candidates);
   int muAssocToTrack( const reco::TrackRef& trackref, const edm::Handle<reco::MuonCollection>& muonh) const;
 
   // ----------member data ---------------------------
@@ -305,13 +310,25 @@ private:
     std::string forestLabel_;
     GBRForest * forest_;
     bool useForestFromDB_;
+    edm::ESWatcher<GBRWrapperRcd> forestWatcher_;
+    GBRForest const * dbForest_;
+    unsigned int forestLookups_;
+    FlatGBRForest flatForest_;
+    CompiledGBRForest compiledForest_;
+    // inputs of the candidates passing the other cuts, evaluated together
+    //  in selectByMVA once the candidate loop is done
+    GBRFeatureMatrix mvaFeatures_;
+    std::vector<unsigned int> mvaCandidates_;
+    std::vector<double> mvaCutInputs_[MVACutMap::kNAxes];
+    std::vector<double> mvaBatch_;
+    std::vector<double> mvaBatchCut_;
     std::vector<float> mvaVals_;
     std::string dbFileName_;
 
     TF2* func_mva;
     std::vector<double> mvaCuts_;
 
-    TH2D* hist_bdtcut;
+    MVACutMap mvaCutMap_;
 
     float mvaMin_;
     float mvaMax_;
@@ -428,6 +445,8 @@ VertexCompositeSelector::VertexCompositeSelector(const edm::ParameterSet& iConfi
     dbFileName_ = "";
 
     forest_ = nullptr;
+    dbForest_ = nullptr;
+    forestLookups_ = 0;
 
     isCentrality_ = false;
     if(iConfig.exists("isCentrality")) isCentrality_ = iConfig.getParameter<bool>("isCentrality");
@@ -457,12 +476,15 @@ VertexCompositeSelector::VertexCompositeSelector(const edm::ParameterSet& iConfi
 
       TString bdtcut_filename;
       if(iConfig.exists("BDTCutFileName")) bdtcut_filename = iConfig.getParameter<string>("BDTCutFileName"); 
-      hist_bdtcut = 0;
+      // cuts in (y, pT) bins, pT clamped to the range of the map
+      mvaCutMap_.setRange(MVACutMap::kY, -2.4, 2.4);
+      mvaCutMap_.setClamp(MVACutMap::kPt, 1.37, 7.4);
       if(!bdtcut_filename.IsNull()) 
       {
         edm::FileInPath fip(Form("VertexCompositeAnalysis/VertexCompositeAnalyzer/data/%s",bdtcut_filename.Data()));
         TFile ff(fip.fullPath().c_str(),"READ");
-        hist_bdtcut = (TH2D*)ff.Get("hist_bdtcut");
+        TH2D* hist_bdtcut = (TH2D*)ff.Get("hist_bdtcut");
+        if(hist_bdtcut) mvaCutMap_.build(*hist_bdtcut, {MVACutMap::kY, MVACutMap::kPt});
         ff.Close();
       }
 
@@ -475,7 +497,10 @@ VertexCompositeSelector::VertexCompositeSelector(const edm::ParameterSet& iConfi
       TFile gbrfile(fip.fullPath().c_str(),"READ");
       forest_ = (GBRForest*)gbrfile.Get(forestLabel_.c_str());
       gbrfile.Close();
+      if(forest_) flatForest_.build(*forest_);
+      compiledForest_ = CompiledGBRForest::find(fip.relativePath(), forestLabel_);
     }
+    mvaFeatures_.setNVars(30);
 
     mvaType_ = type;
 
@@ -536,6 +561,16 @@ VertexCompositeSelector::produce(edm::Event& iEvent, const edm::EventSetup& iSet
 void
 VertexCompositeSelector::fillRECO(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
+    // the forest from the DB is only looked up again when its IOV changes
+    if(useAnyMVA_ && !useExistingMVA_ && useForestFromDB_ && forestWatcher_.check(iSetup))
+    {
+      edm::ESHandle<GBRForest> forestHandle;
+      iSetup.get<GBRWrapperRcd>().get(forestLabel_,forestHandle);
+      dbForest_ = forestHandle.product();
+      flatForest_.build(*dbForest_);
+      forestLookups_++;
+    }
+
     //get collections
     edm::Handle<reco::VertexCollection> vertices;
     iEvent.getByToken(tok_offlinePV_,vertices);
@@ -1470,7 +1505,7 @@ VertexCompositeSelector::fillRECO(edm::Event& iEvent, const edm::EventSetup& iSe
         }
         else if(useAnyMVA_ && !useExistingMVA_)
         {
-          float gbrVals_[50];
+          float gbrVals_[50] = {0};
           if(forestLabel_ == "D0InpPb" || forestLabel_ == "D0Inpp" || forestLabel_ == "D0InPbPb")
           { 
             gbrVals_[0] = pt;
@@ -1552,36 +1587,49 @@ VertexCompositeSelector::fillRECO(edm::Event& iEvent, const edm::EventSetup& iSe
             gbrVals_[29] = eta2;
           }
 
-          GBRForest const * forest = forest_;
-          if(useForestFromDB_){
-            edm::ESHandle<GBRForest> forestHandle;
-            iSetup.get<GBRWrapperRcd>().get(forestLabel_,forestHandle);
-            forest = forestHandle.product();
-          }
+          mvaFeatures_.push_back(gbrVals_);
+          mvaCandidates_.push_back(it);
+          mvaCutInputs_[MVACutMap::kY].push_back(y);
+          mvaCutInputs_[MVACutMap::kPt].push_back(pt);
+          mvaCutInputs_[MVACutMap::kCentrality].push_back(centrality);
+          mvaCutInputs_[MVACutMap::kMultiplicity].push_back(Ntrkoffline);
+          continue;
+        } 
+        theVertexComps.push_back( trk );
+    }
 
-          auto gbrVal = forest->GetClassifier(gbrVals_);
+    if(useAnyMVA_ && !useExistingMVA_) selectByMVA(*v0candidates_);
+}
 
-          if(gbrVal < mvaMin_ || gbrVal > mvaMax_) continue;
-          if(gbrVal < GetMVACut(y,pt)) continue;
+void
+VertexCompositeSelector::selectByMVA(const reco::VertexCompositeCandidateCollection& candidates)
+{
+    if(compiledForest_.isValid()) compiledForest_.GetClassifier(mvaFeatures_, mvaBatch_);
+    else flatForest_.GetClassifier(mvaFeatures_, mvaBatch_);
 
-          theMVANew.push_back( gbrVal );
-        } 
-        theVertexComps.push_back( trk );
+    const unsigned int n = mvaBatch_.size();
+    mvaCutMap_.cuts(mvaCutInputs_, mvaBatchCut_);
+
+    for(unsigned int k = 0; k < n; k++)
+    {
+      const double gbrVal = mvaBatch_[k];
+      const bool pass = !(gbrVal < mvaMin_) & !(gbrVal > mvaMax_) & !(gbrVal < mvaBatchCut_[k]);
+      if(!pass) continue;
+
+      theMVANew.push_back( gbrVal );
+      theVertexComps.push_back( candidates[mvaCandidates_[k]] );
     }
+
+    mvaFeatures_.clear();
+    mvaCandidates_.clear();
+    for(unsigned int axis = 0; axis < MVACutMap::kNAxes; axis++) mvaCutInputs_[axis].clear();
 }
 
 double
 VertexCompositeSelector::GetMVACut(double y, double pt)
 {
-  double mvacut = -1.0;
-  if(fabs(y)>2.4) return mvacut;
-  if(!hist_bdtcut) return mvacut;
-
-  mvacut = hist_bdtcut->GetBinContent(hist_bdtcut->GetXaxis()->FindBin(y),hist_bdtcut->GetYaxis()->FindBin(pt));
-  if(pt>7.4) mvacut = hist_bdtcut->GetBinContent(hist_bdtcut->GetXaxis()->FindBin(y),hist_bdtcut->GetYaxis()->FindBin(7.4));
-  if(pt<1.37) mvacut = hist_bdtcut->GetBinContent(hist_bdtcut->GetXaxis()->FindBin(y),hist_bdtcut->GetYaxis()->FindBin(1.37));
-
-  return mvacut;
+  const double point[MVACutMap::kNAxes] = {y, pt, double(centrality), double(Ntrkoffline)};
+  return mvaCutMap_.cut(point);
 }
 
 int VertexCompositeSelector::
@@ -1606,6 +1654,8 @@ VertexCompositeSelector::beginJob()
 //loop  ------------
 void 
 VertexCompositeSelector::endJob() {
+  if(useAnyMVA_ && !useExistingMVA_ && useForestFromDB_)
+    edm::LogInfo("VertexCompositeSelector") << "GBRForest " << forestLabel_ << " looked up " << forestLookups_ << " times in the EventSetup";
 }
 
 //define this as a plug-in
@@ -0,0 +1,132 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+//
+// Program:    compileGBRForest
+//
+/**\file compileGBRForest.cc VertexCompositeAnalysis/VertexCompositeProducer/bin/compileGBRForest.cc
+
+ Description: writes a GBRForest as a C++ source file registered with
+              CompiledGBRForest
+
+ Usage:
+     compileGBRForest <forest file FileInPath> <forest label> <output .cc>
+
+     e.g.
+     compileGBRForest VertexCompositeAnalysis/VertexCompositeProducer/data/GBRForestfile_BDT_PromptD0InpPb_default_HLT185_WS.root D0InpPb \
+       $CMSSW_BASE/src/VertexCompositeAnalysis/VertexCompositeProducer/src/CompiledGBRForest_PromptD0InpPb_HLT185_WS.cc
+
+     The forest file and label have to be the ones given to the module as
+     GBRForestFileName and GBRForestLabel, and the output has to be placed in
+     the package of that module. Rerun when the forest file changes.
+
+ Implementation:
+     Every tree becomes one nested conditional expression with the cut
+     values and leaf responses as float literals, so that the compiler sees
+     constant operands only and can select leaves with conditional moves.
+     The literals are printed with enough digits to round-trip, and the
+     responses are summed in tree order into a double starting from the
+     initial response, as in GBRForest::GetResponse.
+*/
+//
+//
+
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "CondFormats/EgammaObjects/interface/GBRForest.h"
+
+#include "TFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+  // GBRForest keeps the initial response protected and has no getter
+  struct InitialResponse : public GBRForest {
+    static double of(const GBRForest& forest) { return forest.*(&InitialResponse::fInitialResponse); }
+  };
+
+  std::string floatLiteral(float value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.8ef", value);
+    return buffer;
+  }
+
+  std::string doubleLiteral(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.16e", value);
+    return buffer;
+  }
+
+  void writeNode(std::ostream& out, const GBRTree& tree, int node);
+
+  // index > 0 is a node, otherwise -index is a leaf
+  void writeChild(std::ostream& out, const GBRTree& tree, int index) {
+    if( index > 0 ) writeNode(out, tree, index);
+    else out << floatLiteral(tree.Responses()[-index]);
+  }
+
+  void writeNode(std::ostream& out, const GBRTree& tree, int node) {
+    out << "(x[" << int(tree.CutIndices()[node]) << "] > " << floatLiteral(tree.CutVals()[node]) << " ? ";
+    writeChild(out, tree, tree.RightIndices()[node]);
+    out << " : ";
+    writeChild(out, tree, tree.LeftIndices()[node]);
+    out << ")";
+  }
+}
+
+int main(int argc, char** argv) {
+
+  if( argc != 4 ) {
+    std::cerr << "Usage: " << argv[0] << " <forest file FileInPath> <forest label> <output .cc>" << std::endl;
+    return 1;
+  }
+
+  const std::string fileName = argv[1];
+  const std::string label = argv[2];
+  const std::string outName = argv[3];
+
+  edm::FileInPath fip(fileName);
+  TFile gbrfile(fip.fullPath().c_str(),"READ");
+  GBRForest* forest = (GBRForest*)gbrfile.Get(label.c_str());
+  if( !forest ) {
+    std::cerr << "No GBRForest " << label << " in " << fip.fullPath() << std::endl;
+    return 1;
+  }
+
+  std::ofstream out(outName.c_str());
+  if( !out ) {
+    std::cerr << "Cannot write " << outName << std::endl;
+    return 1;
+  }
+
+  out << "// Generated by compileGBRForest from " << fileName << " (" << label << "), do not edit\n"
+      << "\n"
+      << "#include \"VertexCompositeAnalysis/VertexCompositeProducer/interface/CompiledGBRForest.h\"\n"
+      << "\n"
+      << "namespace {\n"
+      << "  double compiledResponse(const float* x) {\n"
+      << "    double response = " << doubleLiteral(InitialResponse::of(*forest)) << ";\n";
+
+  const std::vector<GBRTree>& trees = forest->Trees();
+  for(unsigned int itree = 0; itree < trees.size(); itree++) {
+    out << "    response += ";
+    writeNode(out, trees[itree], 0);
+    out << ";\n";
+  }
+
+  out << "    return response;\n"
+      << "  }\n"
+      << "\n"
+      << "  CompiledGBRForest::Registrar registrar(\"" << fileName << "\", \"" << label << "\", &compiledResponse);\n"
+      << "}\n";
+
+  const unsigned int nTrees = trees.size();
+  delete forest;
+  gbrfile.Close();
+
+  std::cout << "Wrote " << nTrees << " trees of " << label << " to " << outName << std::endl;
+  return 0;
+}
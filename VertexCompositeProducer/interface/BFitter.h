@@ -62,6 +62,9 @@
 
 #include "CondFormats/EgammaObjects/interface/GBRForest.h"
 
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/DaughterTrackVeto.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPreselection.h"
+
 #include <string>
 #include <fstream>
 #include <typeinfo>
@@ -79,12 +82,18 @@ class BFitter {
   void fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup);
 
   const reco::VertexCompositeCandidateCollection& getB() const;
+
+  // Hand the candidates over to the caller, leaving them empty
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseB();
+  // Wrong-sign candidates, filled with produceBothSignsB only
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseBWS();
 //  const std::vector<float>& getMVAVals() const; 
 
   void resetAll();
 
  private:
   reco::VertexCompositeCandidateCollection theBs;
+  reco::VertexCompositeCandidateCollection theBsWS;
 
   // Tracker geometry for discerning hit positions
   const TrackerGeometry* trackerGeom;
@@ -126,9 +135,15 @@ class BFitter {
   double bAlphaCut;
   double bAlpha2DCut;
   bool   isWrongSignB;
+  bool   produceBothSignsB;
 
   std::vector<reco::TrackBase::TrackQuality> qualities;
 
+  TrackPreselection thePreselection;
+
+  // bachelor tracks that are daughters of the current D0
+  DaughterTrackVeto theDaughterVeto;
+
   //setup mva selector
 /*
   bool useAnyMVA_;
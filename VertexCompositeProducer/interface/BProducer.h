@@ -51,6 +51,7 @@ private:
   virtual void endJob() ;
 
 //  bool useAnyMVA_;
+  bool produceBothSignsB_;
 
   BFitter theVees; 
 //  edm::ParameterSet theParams;
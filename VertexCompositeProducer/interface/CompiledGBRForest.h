@@ -0,0 +1,94 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      CompiledGBRForest
+//
+/**\class CompiledGBRForest CompiledGBRForest.h VertexCompositeAnalysis/VertexCompositeProducer/interface/CompiledGBRForest.h
+
+ Description: registry of GBRForests compiled ahead of time into C++
+              functions
+
+ Implementation:
+     The compileGBRForest executable (bin/) writes one source file per
+     forest, with every cut and leaf response as a literal. The generated
+     file is added to the src/ or plugins/ directory of the package whose
+     modules use the forest, and registers its response function at load
+     time under the FileInPath of the forest file and the forest label.
+
+     The modules look the forest up with find() when they load it from a
+     file and keep using GBRForest when nothing is registered. Forests
+     taken from the conditions DB are never replaced, since their payload
+     can change with the IOV.
+
+     The generated code sums the tree responses in the same order and
+     precision as GBRForest::GetResponse, so the values are identical.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__COMPILED_GBR_FOREST_H
+#define VertexCompositeAnalysis__COMPILED_GBR_FOREST_H
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/FlatGBRForest.h"
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+class CompiledGBRForest {
+ public:
+  typedef double (*ResponseFunction)(const float*);
+
+  // Registers a generated response function, one static instance per generated file
+  struct Registrar {
+    Registrar(const char* fileName, const char* label, ResponseFunction response) {
+      registry()[key(fileName, label)] = response;
+    }
+  };
+
+  CompiledGBRForest() : theResponse(nullptr) {}
+
+  // fileName is the FileInPath of the forest file, e.g.
+  //  VertexCompositeAnalysis/VertexCompositeProducer/data/GBRForestfile.root
+  static CompiledGBRForest find(const std::string& fileName, const std::string& label) {
+    CompiledGBRForest forest;
+    std::map<std::string, ResponseFunction>::const_iterator it = registry().find(key(fileName, label));
+    if( it != registry().end() ) forest.theResponse = it->second;
+    return forest;
+  }
+
+  bool isValid() const { return theResponse != nullptr; }
+
+  // Same as GBRForest::GetResponse
+  double GetResponse(const float* vector) const { return theResponse(vector); }
+
+  // Same as GBRForest::GetClassifier
+  double GetClassifier(const float* vector) const {
+    return 2.0/(1.0+exp(-2.0*GetResponse(vector)))-1;
+  }
+
+  // Classifier values of all candidates in features, in the same order
+  void GetClassifier(const GBRFeatureMatrix& features, std::vector<double>& values) const {
+    std::vector<float> vector(features.nVars());
+    values.resize(features.size());
+    for(unsigned int k = 0; k < values.size(); k++) {
+      for(unsigned int var = 0; var < vector.size(); var++) vector[var] = features.column(var)[k];
+      values[k] = GetClassifier(vector.data());
+    }
+  }
+
+ private:
+  static std::string key(const std::string& fileName, const std::string& label) {
+    return fileName + ":" + label;
+  }
+
+  static std::map<std::string, ResponseFunction>& registry() {
+    static std::map<std::string, ResponseFunction> theRegistry;
+    return theRegistry;
+  }
+
+  ResponseFunction theResponse;
+};
+
+#endif
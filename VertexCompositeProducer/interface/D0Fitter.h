@@ -20,6 +20,7 @@
 
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/ESHandle.h"
+#include "FWCore/Framework/interface/ESWatcher.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 #include "FWCore/Framework/interface/ConsumesCollector.h"
 
@@ -63,6 +64,14 @@
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 
 #include "CondFormats/EgammaObjects/interface/GBRForest.h"
+#include "CondFormats/DataRecord/interface/GBRWrapperRcd.h"
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackStateTable.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/HelixDCAPrefilter.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/MassHypothesisFilter.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/FlatGBRForest.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/CompiledGBRForest.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPreselection.h"
 
 #include <string>
 #include <fstream>
@@ -84,12 +93,23 @@ class D0Fitter {
   const reco::VertexCompositeCandidateCollection& getD0() const;
   const std::vector<float>& getMVAVals() const; 
 
+  // Hand the candidates (and MVA values) over to the caller, leaving them empty
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseD0();
+  std::unique_ptr<std::vector<float> > releaseMVAVals();
+  // Wrong-sign candidates (and MVA values), filled with produceBothSigns only
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseD0WS();
+  std::unique_ptr<std::vector<float> > releaseMVAValsWS();
+
+  // Number of times the GBRForest was looked up in the EventSetup
+  unsigned int forestLookups() const;
+
 //  auto_ptr<edm::ValueMap<float> > getMVAMap() const;
   void resetAll();
 
  private:
   // STL vector of VertexCompositeCandidate that will be filled with VertexCompositeCandidates by fitAll()
   reco::VertexCompositeCandidateCollection theD0s;
+  reco::VertexCompositeCandidateCollection theD0sWS;
 
   // Tracker geometry for discerning hit positions
   const TrackerGeometry* trackerGeom;
@@ -129,9 +149,19 @@ class D0Fitter {
   double alphaCut;
   double alpha2DCut;
   bool   isWrongSign;
+  bool   produceBothSigns;
+  bool   sharedVertexFit;
+  double sharedFitEdgeMargin;
 
   std::vector<reco::TrackBase::TrackQuality> qualities;
 
+  TrackPreselection thePreselection;
+
+  // impact-point states of the preselected tracks, rebuilt every event
+  TrackStateTable theTrackStates;
+  HelixDCAPrefilter theTrackCircles;
+  MassHypothesisFilter<2> thePairMassFilter;
+
   //setup mva selector
   bool useAnyMVA_;
   std::vector<bool> useMVA_;
@@ -140,8 +170,21 @@ class D0Fitter {
   std::string forestLabel_;
   GBRForest * forest_;
   bool useForestFromDB_;
+  edm::ESWatcher<GBRWrapperRcd> forestWatcher_;
+  GBRForest const * dbForest_;
+  unsigned int forestLookups_;
+
+  // flattened copy of the forest in use, the candidates of an event are
+  //  evaluated together at the end of fitAll
+  FlatGBRForest flatForest_;
+  GBRFeatureMatrix mvaFeatures_;
+  std::vector<double> mvaBatch_;
+  std::vector<char> mvaWrongSign_;
+  // generated code for the forest file, if any was compiled in
+  CompiledGBRForest compiledForest_;
 
   std::vector<float> mvaVals_;
+  std::vector<float> mvaValsWS_;
 
 //  auto_ptr<edm::ValueMap<float> >mvaValValueMap;
 //  MVACollection mvas; 
@@ -51,6 +51,7 @@ private:
   virtual void endJob() ;
 
   bool useAnyMVA_;
+  bool produceBothSigns_;
 
   D0Fitter theVees; 
 //  edm::ParameterSet theParams;
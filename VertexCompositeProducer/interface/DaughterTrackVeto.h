@@ -0,0 +1,92 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      DaughterTrackVeto
+//
+/**\class DaughterTrackVeto DaughterTrackVeto.h VertexCompositeAnalysis/VertexCompositeProducer/interface/DaughterTrackVeto.h
+
+ Description: tells whether a preselected track is a daughter of the
+              current parent candidate
+
+ Implementation:
+     The daughters of a parent candidate are marked by key in a flag array
+     sized to the track collection of the event, so the test of a track is
+     a single lookup. Only the marks of the previous parent are cleared
+     when the next one is set.
+
+     The keys are only comparable for daughters and tested tracks taken
+     from the same collection. Daughters with another product id, and
+     tested tracks from another collection than the one given to reset(),
+     fall back to the former comparison of charge and momentum.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__DAUGHTER_TRACK_VETO_H
+#define VertexCompositeAnalysis__DAUGHTER_TRACK_VETO_H
+
+#include "DataFormats/Provenance/interface/ProductID.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+
+#include <vector>
+
+class DaughterTrackVeto {
+ public:
+  DaughterTrackVeto() {}
+
+  // Once per event, with the collection of the tracks that are tested
+  void reset(const edm::ProductID& theTracksID, unsigned int nTracks) {
+    theProductID = theTracksID;
+    theMarked.assign(nTracks, 0);
+    theMarkedKeys.clear();
+    theDaughters.clear();
+    theForeignDaughters.clear();
+  }
+
+  // Daughters of the next parent candidate, replacing the previous ones
+  void setDaughters(const std::vector<reco::TrackRef>& theDaughterTracks) {
+    for(unsigned int indx = 0; indx < theMarkedKeys.size(); indx++) theMarked[theMarkedKeys[indx]] = 0;
+    theMarkedKeys.clear();
+    theDaughters.clear();
+    theForeignDaughters.clear();
+
+    for(unsigned int indx = 0; indx < theDaughterTracks.size(); indx++) {
+      const reco::TrackRef& theDaughter = theDaughterTracks[indx];
+      if( theDaughter.isNull() ) continue;
+      theDaughters.push_back(theDaughter);
+      if( theDaughter.id() == theProductID && theDaughter.key() < theMarked.size() ) {
+        theMarked[theDaughter.key()] = 1;
+        theMarkedKeys.push_back(theDaughter.key());
+      }
+      else theForeignDaughters.push_back(theDaughter);
+    }
+  }
+
+  bool isDaughter(const reco::TrackRef& theTrack) const {
+    // keys of another collection say nothing about the marked daughters
+    if( theTrack.id() != theProductID ) return sameTrack(theTrack, theDaughters);
+
+    if( theTrack.key() < theMarked.size() && theMarked[theTrack.key()] ) return true;
+    return sameTrack(theTrack, theForeignDaughters);
+  }
+
+ private:
+  // The comparison the fitters used before the keys
+  static bool sameTrack(const reco::TrackRef& theTrack, const std::vector<reco::TrackRef>& theDaughterTracks) {
+    for(unsigned int indx = 0; indx < theDaughterTracks.size(); indx++) {
+      const reco::TrackRef& theDaughter = theDaughterTracks[indx];
+      if( theTrack->charge() == theDaughter->charge() &&
+          theTrack->momentum() == theDaughter->momentum() ) return true;
+    }
+    return false;
+  }
+
+  edm::ProductID theProductID;
+  std::vector<char> theMarked;
+  std::vector<unsigned int> theMarkedKeys;
+  std::vector<reco::TrackRef> theDaughters;
+  std::vector<reco::TrackRef> theForeignDaughters;
+};
+
+#endif
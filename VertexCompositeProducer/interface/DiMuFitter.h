@@ -31,6 +31,7 @@
 #include "DataFormats/TrackReco/interface/TrackFwd.h"
 #include <DataFormats/MuonReco/interface/Muon.h>
 #include <DataFormats/MuonReco/interface/MuonFwd.h>
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
 #include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
 #include "TrackingTools/TransientTrack/interface/TransientTrack.h"
 #include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
@@ -68,6 +69,8 @@
 
 #include <string>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 class DiMuFitter {
  public:
@@ -77,6 +80,9 @@ class DiMuFitter {
   void fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup);
 
   const reco::VertexCompositeCandidateCollection& getDiMu() const;
+
+  // Hand the candidates over to the caller, leaving them empty
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseDiMu();
   void resetAll();
 
  private:
@@ -123,8 +129,22 @@ class DiMuFitter {
   bool   isPFMuon;
   bool   isGlobalMuon;
   bool   isWrongSign;
+  muon::SelectionType muonSelectionType;
 
   std::vector<reco::TrackBase::TrackQuality> qualities;
+
+  // Muon passing the preselection, with the quantities used by the pairs
+  struct PreselectedMuon {
+    unsigned int indx;                 // index in the muon collection
+    reco::TrackRef trackRef;
+    reco::TransientTrack transTrack;
+    double dauTransImpactSig;
+    double dauLongImpactSig;
+  };
+
+  // preselected muons of each charge, refilled every event
+  std::vector<PreselectedMuon> thePosMuons;
+  std::vector<PreselectedMuon> theNegMuons;
 };
 
 #endif
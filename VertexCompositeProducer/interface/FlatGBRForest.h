@@ -0,0 +1,174 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      FlatGBRForest
+//
+/**\class FlatGBRForest FlatGBRForest.h VertexCompositeAnalysis/VertexCompositeProducer/interface/FlatGBRForest.h
+
+ Description: GBRForest evaluation from contiguous node arrays, for one
+              candidate or for a whole block of candidates
+
+ Implementation:
+     The nodes of all trees are copied into flat arrays (cut variable, cut
+     value, left and right child) with absolute indices. A negative child
+     index -(leaf+1) points into the flat array of leaf responses.
+
+     The batch evaluation runs over a GBRFeatureMatrix, which keeps every
+     input variable as a contiguous column, and is tree-major: each tree is
+     walked for a block of candidates in lock step, one level per pass, so
+     the cut comparisons of a level are a branch-free loop over the block.
+     The tree responses are summed in tree order starting from the initial
+     response, exactly as in GBRForest::GetResponse, so the classifier
+     values are identical to GBRForest::GetClassifier.
+
+     Header-only, so that the analyzer plugins can use it as well.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__FLAT_GBR_FOREST_H
+#define VertexCompositeAnalysis__FLAT_GBR_FOREST_H
+
+#include "CondFormats/EgammaObjects/interface/GBRForest.h"
+
+#include <cmath>
+#include <vector>
+
+// Candidates x input variables, stored column by column
+class GBRFeatureMatrix {
+ public:
+  explicit GBRFeatureMatrix(unsigned int nVars = 0) : theColumns(nVars) {}
+
+  void setNVars(unsigned int nVars) { theColumns.assign(nVars, std::vector<float>()); }
+  unsigned int nVars() const { return theColumns.size(); }
+  unsigned int size() const { return theColumns.empty() ? 0 : theColumns[0].size(); }
+
+  void clear() {
+    for(unsigned int var = 0; var < theColumns.size(); var++) theColumns[var].clear();
+  }
+
+  // vars holds the nVars() inputs of one candidate, in GBRForest order
+  void push_back(const float* vars) {
+    for(unsigned int var = 0; var < theColumns.size(); var++) theColumns[var].push_back(vars[var]);
+  }
+
+  const float* column(unsigned int var) const { return theColumns[var].data(); }
+
+ private:
+  std::vector<std::vector<float> > theColumns;
+};
+
+class FlatGBRForest {
+ public:
+  FlatGBRForest() : theInitialResponse(0.), theNVars(0) {}
+  explicit FlatGBRForest(const GBRForest& forest) : theInitialResponse(0.), theNVars(0) { build(forest); }
+
+  void build(const GBRForest& forest) {
+    theInitialResponse = InitialResponse::of(forest);
+    theRoots.clear();
+    theCutIndices.clear();
+    theCutVals.clear();
+    theLefts.clear();
+    theRights.clear();
+    theResponses.clear();
+    theNVars = 0;
+
+    const std::vector<GBRTree>& trees = forest.Trees();
+    for(unsigned int itree = 0; itree < trees.size(); itree++) {
+      const GBRTree& tree = trees[itree];
+      const int nodeOffset = theCutVals.size();
+      const int leafOffset = theResponses.size();
+      theRoots.push_back(nodeOffset);
+
+      for(unsigned int node = 0; node < tree.CutVals().size(); node++) {
+        theCutIndices.push_back(tree.CutIndices()[node]);
+        theCutVals.push_back(tree.CutVals()[node]);
+        theLefts.push_back(child(tree.LeftIndices()[node], nodeOffset, leafOffset));
+        theRights.push_back(child(tree.RightIndices()[node], nodeOffset, leafOffset));
+        if( tree.CutIndices()[node] + 1u > theNVars ) theNVars = tree.CutIndices()[node] + 1u;
+      }
+      theResponses.insert(theResponses.end(), tree.Responses().begin(), tree.Responses().end());
+    }
+  }
+
+  // Number of input variables used by the trees
+  unsigned int nVars() const { return theNVars; }
+
+  // Same as GBRForest::GetResponse
+  double GetResponse(const float* vector) const {
+    double response = theInitialResponse;
+    for(unsigned int itree = 0; itree < theRoots.size(); itree++) {
+      int node = theRoots[itree];
+      while( node >= 0 ) node = vector[theCutIndices[node]] > theCutVals[node] ? theRights[node] : theLefts[node];
+      response += theResponses[-node-1];
+    }
+    return response;
+  }
+
+  // Same as GBRForest::GetClassifier
+  double GetClassifier(const float* vector) const {
+    return classifier(GetResponse(vector));
+  }
+
+  // Classifier values of all candidates in features, in the same order
+  void GetClassifier(const GBRFeatureMatrix& features, std::vector<double>& values) const {
+    const unsigned int n = features.size();
+    values.assign(n, theInitialResponse);
+    if( n == 0 ) return;
+
+    std::vector<const float*> columns(features.nVars());
+    for(unsigned int var = 0; var < columns.size(); var++) columns[var] = features.column(var);
+
+    int nodes[kBlockSize];
+    for(unsigned int itree = 0; itree < theRoots.size(); itree++) {
+      for(unsigned int first = 0; first < n; first += kBlockSize) {
+        const unsigned int nBlock = (n - first < kBlockSize) ? n - first : kBlockSize;
+        for(unsigned int k = 0; k < nBlock; k++) nodes[k] = theRoots[itree];
+
+        bool active = true;
+        while( active ) {
+          active = false;
+          for(unsigned int k = 0; k < nBlock; k++) {
+            const int node = nodes[k];
+            if( node < 0 ) continue;
+            const bool right = columns[theCutIndices[node]][first + k] > theCutVals[node];
+            nodes[k] = right ? theRights[node] : theLefts[node];
+            active |= (nodes[k] >= 0);
+          }
+        }
+
+        for(unsigned int k = 0; k < nBlock; k++) values[first + k] += theResponses[-nodes[k]-1];
+      }
+    }
+
+    for(unsigned int k = 0; k < n; k++) values[k] = classifier(values[k]);
+  }
+
+ private:
+  static const unsigned int kBlockSize = 16;
+
+  // GBRForest keeps the initial response protected and has no getter
+  struct InitialResponse : public GBRForest {
+    static double of(const GBRForest& forest) { return forest.*(&InitialResponse::fInitialResponse); }
+  };
+
+  static int child(int index, int nodeOffset, int leafOffset) {
+    return index > 0 ? nodeOffset + index : -(leafOffset - index) - 1;
+  }
+
+  static double classifier(double response) {
+    return 2.0/(1.0+exp(-2.0*response))-1;
+  }
+
+  double theInitialResponse;
+  unsigned int theNVars;
+
+  std::vector<int> theRoots;
+  std::vector<unsigned char> theCutIndices;
+  std::vector<float> theCutVals;
+  std::vector<int> theLefts;
+  std::vector<int> theRights;
+  std::vector<float> theResponses;
+};
+
+#endif
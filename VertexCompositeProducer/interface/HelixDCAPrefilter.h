@@ -0,0 +1,192 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      HelixDCAPrefilter
+//
+/**\class HelixDCAPrefilter HelixDCAPrefilter.h VertexCompositeAnalysis/VertexCompositeProducer/interface/HelixDCAPrefilter.h
+
+ Description: batched transverse closest-approach prefilter for track pairs
+
+ Implementation:
+     Each track is reduced to its circle in the transverse plane (centre
+     and radius, built the same way as in ClosestApproachInRPhi) and the
+     circles are stored as a structure of arrays. The points returned by
+     ClosestApproachInRPhi lie on the two circles, so the gap between the
+     circles,
+         max( d - (r1+r2), |r1-r2| - d ),  d = distance of the centres,
+     is a lower bound of the distance it computes. One track is tested
+     against a contiguous block of partners in a branch-free loop and only
+     pairs whose gap is within the DCA cut are kept for the exact
+     calculation.
+
+     The crossing point is the midpoint of the two closest points, so for
+     a pair passing the DCA cut it lies within dca/2 of each circle. A
+     track whose circle stays farther than rMax + dca/2 from the beam line
+     can therefore never give a crossing point inside the rMax fiducial
+     cylinder. The |z| cut is not prefiltered.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__HELIX_DCA_PREFILTER_H
+#define VertexCompositeAnalysis__HELIX_DCA_PREFILTER_H
+
+#include "MagneticField/Engine/interface/MagneticField.h"
+#include "TrackingTools/TrajectoryState/interface/FreeTrajectoryState.h"
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackStateTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+class HelixDCAPrefilter {
+ public:
+  struct Circle {
+    double xc;
+    double yc;
+    double r;
+    double rMin;   // smallest distance of the circle to the beam line
+    bool   valid;  // false for neutral states or vanishing field
+  };
+
+  HelixDCAPrefilter() {}
+
+  static Circle circle(const FreeTrajectoryState& theState) {
+    Circle theCircle = {0., 0., 0., 0., false};
+
+    const GlobalPoint pos = theState.position();
+    const GlobalVector mom = theState.momentum();
+    const double bz = theState.parameters().magneticField().inTesla(pos).z() * 2.99792458e-3;
+    if( theState.charge() == 0 || bz == 0. ) return theCircle;
+
+    const double qob = theState.charge()/bz;
+    theCircle.xc = pos.x() + qob * mom.y();
+    theCircle.yc = pos.y() - qob * mom.x();
+    theCircle.r = std::abs(qob) * mom.perp();
+    theCircle.rMin = std::abs( std::sqrt(theCircle.xc*theCircle.xc + theCircle.yc*theCircle.yc) - theCircle.r );
+    theCircle.valid = true;
+    return theCircle;
+  }
+
+  // Slot k holds the circle of track indices[k]; invalid states are
+  //  stored as always-passing slots.
+  void fill(const TrackStateTable& theStates, const std::vector<unsigned int>& indices) {
+    clear();
+    for(unsigned int slot = 0; slot < indices.size(); slot++) {
+      const unsigned int indx = indices[slot];
+      if( theStates.isValid(indx) ) push_back( circle(theStates.state(indx)) );
+      else {
+        Circle invalid = {0., 0., 0., 0., false};
+        push_back(invalid);
+      }
+    }
+  }
+
+  // Slot k holds the circle of track k
+  void fill(const TrackStateTable& theStates) {
+    std::vector<unsigned int> indices(theStates.size());
+    for(unsigned int indx = 0; indx < indices.size(); indx++) indices[indx] = indx;
+    fill(theStates, indices);
+  }
+
+  // Slot k holds circles[k]
+  void fill(const std::vector<Circle>& circles) {
+    clear();
+    for(unsigned int slot = 0; slot < circles.size(); slot++) push_back(circles[slot]);
+  }
+
+  unsigned int size() const { return theXc.size(); }
+  const Circle& circleAt(unsigned int slot) const { return theCircles[slot]; }
+
+  // Append to survivors the slots in [first, last) whose circle may come
+  //  within maxDCA of theCircle. With maxRadius > 0 the slots which can
+  //  only produce crossing points outside that radius are dropped as well.
+  void select(const Circle& theCircle, unsigned int first, unsigned int last,
+              double maxDCA, double maxRadius,
+              std::vector<unsigned int>& survivors) const {
+    if( last <= first ) return;
+
+    if( !theCircle.valid ) {
+      for(unsigned int slot = first; slot < last; slot++) survivors.push_back(slot);
+      return;
+    }
+
+    const double x0 = theCircle.xc;
+    const double y0 = theCircle.yc;
+    const double r0 = theCircle.r;
+    const double dcaMax = maxDCA + dcaTolerance;
+    const double rMinMax = maxRadius > 0. ? maxRadius + 0.5*maxDCA + dcaTolerance : 1.e300;
+
+    // fixed-size blocks keep the mask on the stack, so select() can be
+    //  called concurrently on the same prefilter
+    const unsigned int blockSize = 256;
+    char mask[blockSize];
+
+    for(unsigned int begin = first; begin < last; begin += blockSize) {
+      const unsigned int n = std::min(blockSize, last - begin);
+
+      const double* xc = &theXc[begin];
+      const double* yc = &theYc[begin];
+      const double* r = &theR[begin];
+      const double* rMin = &theRMin[begin];
+      const double* force = &theForcePass[begin];
+
+      // branch-free so that the compiler can vectorize the block
+      for(unsigned int k = 0; k < n; k++) {
+        const double dx = xc[k] - x0;
+        const double dy = yc[k] - y0;
+        const double d = std::sqrt(dx*dx + dy*dy);
+        const double gapOut = d - (r0 + r[k]);
+        const double gapIn = std::abs(r0 - r[k]) - d;
+        const double gap = gapOut > gapIn ? gapOut : gapIn;
+        const double cut = dcaMax + dcaRelTolerance*(r0 + r[k]);
+        mask[k] = (force[k] > 0.) | ((gap <= cut) & (rMin[k] <= rMinMax));
+      }
+
+      for(unsigned int k = 0; k < n; k++) {
+        if( mask[k] ) survivors.push_back(begin + k);
+      }
+    }
+  }
+
+  // false if the track can only give crossing points outside maxRadius
+  static bool insideRadius(const Circle& theCircle, double maxDCA, double maxRadius) {
+    if( !theCircle.valid || maxRadius <= 0. ) return true;
+    return theCircle.rMin <= maxRadius + 0.5*maxDCA + dcaTolerance;
+  }
+
+ private:
+  // Slack on the DCA cut. ClosestApproachInRPhi works in double precision
+  //  from the same states, so this only has to cover rounding on large radii.
+  static constexpr double dcaTolerance = 1.e-3;
+  static constexpr double dcaRelTolerance = 1.e-6;
+
+  void clear() {
+    theCircles.clear();
+    theXc.clear();
+    theYc.clear();
+    theR.clear();
+    theRMin.clear();
+    theForcePass.clear();
+  }
+
+  void push_back(const Circle& theCircle) {
+    theCircles.push_back(theCircle);
+    theXc.push_back(theCircle.xc);
+    theYc.push_back(theCircle.yc);
+    theR.push_back(theCircle.r);
+    theRMin.push_back(theCircle.rMin);
+    theForcePass.push_back(theCircle.valid ? 0. : 1.);
+  }
+
+  std::vector<Circle> theCircles;
+
+  std::vector<double> theXc;
+  std::vector<double> theYc;
+  std::vector<double> theR;
+  std::vector<double> theRMin;
+  std::vector<double> theForcePass;
+};
+
+#endif
@@ -64,6 +64,10 @@
 
 #include "CondFormats/EgammaObjects/interface/GBRForest.h"
 
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/PreselectedTrackStore.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/MassHypothesisFilter.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPreselection.h"
+
 #include <string>
 #include <fstream>
 #include <typeinfo>
@@ -80,10 +84,8 @@ class LamC3PFitter {
 
   void fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup);
   void fitLamCCandidates(
-                          std::vector<reco::TrackRef> theTrackRefs_sgn1,
-                          std::vector<reco::TrackRef> theTrackRefs_sgn2,
-                          std::vector<reco::TransientTrack> theTransTracks_sgn1,
-                          std::vector<reco::TransientTrack> theTransTracks_sgn2,
+                          const PreselectedTrackStore& theTracks_sgn1,
+                          const PreselectedTrackStore& theTracks_sgn2,
                           bool isVtxPV, 
                           reco::VertexCollection::const_iterator vtxPrimary, edm::Handle<reco::BeamSpot> theBeamSpotHandle,
                           math::XYZPoint bestvtx, math::XYZPoint bestvtxError,
@@ -94,6 +96,10 @@ class LamC3PFitter {
   const reco::VertexCompositeCandidateCollection& getLamC3P() const;
   const std::vector<float>& getMVAVals() const; 
 
+  // Hand the candidates (and MVA values) over to the caller, leaving them empty
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseLamC3P();
+  std::unique_ptr<std::vector<float> > releaseMVAVals();
+
 //  auto_ptr<edm::ValueMap<float> > getMVAMap() const;
   void resetAll();
 
@@ -142,8 +148,19 @@ class LamC3PFitter {
   double alpha2DCut;
   bool   isWrongSign;
 
+  bool parallelPairLoop;
+  unsigned int pairLoopGrainSize;
+
   std::vector<reco::TrackBase::TrackQuality> qualities;
 
+  TrackPreselection thePreselection;
+
+  // preselected tracks of each charge, refilled every event
+  PreselectedTrackStore thePosTracks;
+  PreselectedTrackStore theNegTracks;
+  MassHypothesisFilter<2> thePairMassFilter;
+  MassHypothesisFilter<3> theTripletMassFilter;
+
   //setup mva selector
   bool useAnyMVA_;
   std::vector<bool> useMVA_;
@@ -0,0 +1,191 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      MassHypothesisFilter
+//
+/**\class MassHypothesisFilter MassHypothesisFilter.h VertexCompositeAnalysis/VertexCompositeProducer/interface/MassHypothesisFilter.h
+
+ Description: batched invariant-mass window test of N-track combinations
+              under several daughter mass assignments
+
+ Implementation:
+     The fitters collect the daughter momenta at the crossing point of all
+     combinations built around one track, then call select() once. The
+     momenta are kept as structure-of-arrays columns of type T and every
+     mass hypothesis is evaluated over the whole block in a branch-free
+     loop. Combinations whose T-precision mass is within the rounding
+     margin of a window edge are re-evaluated with the arithmetic the
+     fitters used before, so the decisions do not depend on T: the daughter
+     energies are computed in the precision of the squared masses given to
+     addHypothesis (float in D0Fitter and LamC3PFitter, double in V0Fitter)
+     and summed in double.
+
+     With requireAll a combination has to pass every hypothesis (V0: both
+     pipi and KK windows), otherwise any one of them (D0: Kpi or piK).
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__MASS_HYPOTHESIS_FILTER_H
+#define VertexCompositeAnalysis__MASS_HYPOTHESIS_FILTER_H
+
+#include "DataFormats/GeometryVector/interface/GlobalVector.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+template <unsigned int N, typename T = float>
+class MassHypothesisFilter {
+ public:
+  explicit MassHypothesisFilter(bool requireAll = true) : theRequireAll(requireAll) {}
+
+  // dauMassesSquared holds the N squared daughter masses of the
+  //  hypothesis, in the order the momenta are given to push_back. With
+  //  float masses the daughter energies of the exact test are computed in
+  //  float, as in the scalar cuts of the fitters using float constants.
+  void addHypothesis(const float* dauMassesSquared, double mMin, double mMax) {
+    double massSquared[N];
+    for(unsigned int dau = 0; dau < N; dau++) massSquared[dau] = dauMassesSquared[dau];
+    add(massSquared, true, mMin, mMax);
+  }
+  void addHypothesis(const double* dauMassesSquared, double mMin, double mMax) {
+    add(dauMassesSquared, false, mMin, mMax);
+  }
+
+  void setRequireAll(bool requireAll) { theRequireAll = requireAll; }
+
+  void clear() {
+    for(unsigned int dau = 0; dau < N; dau++) {
+      theMomenta[dau].clear();
+      thePx[dau].clear();
+      thePy[dau].clear();
+      thePz[dau].clear();
+      theP2[dau].clear();
+    }
+    theDecisions.clear();
+  }
+
+  unsigned int size() const { return theMomenta[0].size(); }
+
+  // momenta[dau] is the momentum of daughter dau at the crossing point
+  void push_back(const GlobalVector* momenta) {
+    for(unsigned int dau = 0; dau < N; dau++) {
+      theMomenta[dau].push_back(momenta[dau]);
+      thePx[dau].push_back(momenta[dau].x());
+      thePy[dau].push_back(momenta[dau].y());
+      thePz[dau].push_back(momenta[dau].z());
+      theP2[dau].push_back(momenta[dau].mag2());
+    }
+  }
+
+  // One flag per combination, in push_back order
+  const std::vector<char>& select() {
+    const unsigned int n = size();
+    theDecisions.assign(n, theRequireAll ? 1 : 0);
+    if( theHypotheses.empty() ) {
+      theDecisions.assign(n, 1);
+      return theDecisions;
+    }
+    theStatus.resize(n);
+
+    for(unsigned int ih = 0; ih < theHypotheses.size(); ih++) {
+      const Hypothesis& hyp = theHypotheses[ih];
+      evaluate(hyp);
+
+      for(unsigned int k = 0; k < n; k++) {
+        if( theStatus[k] == kAmbiguous ) theStatus[k] = exactPass(hyp, k) ? kInside : kOutside;
+      }
+
+      if( theRequireAll ) {
+        for(unsigned int k = 0; k < n; k++) theDecisions[k] &= (theStatus[k] == kInside);
+      }
+      else {
+        for(unsigned int k = 0; k < n; k++) theDecisions[k] |= (theStatus[k] == kInside);
+      }
+    }
+    return theDecisions;
+  }
+
+ private:
+  enum Status { kOutside = 0, kInside = 1, kAmbiguous = 2 };
+
+  struct Hypothesis {
+    double massSquared[N];
+    bool floatEnergies;
+    double mMin;
+    double mMax;
+    double m2Low;
+    double m2High;
+  };
+
+  void add(const double* massSquared, bool floatEnergies, double mMin, double mMax) {
+    Hypothesis hyp;
+    for(unsigned int dau = 0; dau < N; dau++) hyp.massSquared[dau] = massSquared[dau];
+    hyp.floatEnergies = floatEnergies;
+    hyp.mMin = mMin;
+    hyp.mMax = mMax;
+    hyp.m2Low = mMin > 0. ? mMin*mMin : -std::numeric_limits<double>::infinity();
+    hyp.m2High = mMax >= 0. ? mMax*mMax : -std::numeric_limits<double>::infinity();
+    theHypotheses.push_back(hyp);
+  }
+
+  // T-precision pass over the block, flags the combinations near an edge
+  void evaluate(const Hypothesis& hyp) {
+    const unsigned int n = size();
+    const T margin = T(64)*std::numeric_limits<T>::epsilon();
+    const T low = bound(hyp.m2Low);
+    const T high = bound(hyp.m2High);
+
+    for(unsigned int k = 0; k < n; k++) {
+      T e = 0, px = 0, py = 0, pz = 0;
+      for(unsigned int dau = 0; dau < N; dau++) {
+        e += std::sqrt(theP2[dau][k] + T(hyp.massSquared[dau]));
+        px += thePx[dau][k];
+        py += thePy[dau][k];
+        pz += thePz[dau][k];
+      }
+      const T e2 = e*e;
+      const T m2 = e2 - (px*px + py*py + pz*pz);
+      const T tol = margin*e2;
+      const bool inside = (m2 >= low + tol) & (m2 <= high - tol);
+      const bool outside = (m2 < low - tol) | (m2 > high + tol);
+      theStatus[k] = inside ? kInside : (outside ? kOutside : kAmbiguous);
+    }
+  }
+
+  // Window edge in T precision. Values outside the range of T become
+  //  infinite, since converting them to T is undefined.
+  static T bound(double m2) {
+    if( m2 > double(std::numeric_limits<T>::max()) ) return std::numeric_limits<T>::infinity();
+    if( m2 < double(std::numeric_limits<T>::lowest()) ) return -std::numeric_limits<T>::infinity();
+    return T(m2);
+  }
+
+  // Same arithmetic as the scalar cuts in the fitters
+  bool exactPass(const Hypothesis& hyp, unsigned int k) const {
+    double totalE = 0.;
+    GlobalVector totalP(0., 0., 0.);
+    for(unsigned int dau = 0; dau < N; dau++) {
+      if( hyp.floatEnergies ) totalE += std::sqrt( theMomenta[dau][k].mag2() + float(hyp.massSquared[dau]) );
+      else totalE += std::sqrt( theMomenta[dau][k].mag2() + hyp.massSquared[dau] );
+      totalP += theMomenta[dau][k];
+    }
+    const double mass = std::sqrt( totalE*totalE - totalP.mag2() );
+    return !( mass > hyp.mMax || mass < hyp.mMin );
+  }
+
+  bool theRequireAll;
+  std::vector<Hypothesis> theHypotheses;
+
+  std::vector<GlobalVector> theMomenta[N];
+  std::vector<T> thePx[N];
+  std::vector<T> thePy[N];
+  std::vector<T> thePz[N];
+  std::vector<T> theP2[N];
+
+  std::vector<char> theStatus;
+  std::vector<char> theDecisions;
+};
+
+#endif
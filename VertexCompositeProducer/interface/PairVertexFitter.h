@@ -0,0 +1,53 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      PairVertexFitter
+//
+/**\class PairVertexFitter PairVertexFitter.h VertexCompositeAnalysis/VertexCompositeProducer/interface/PairVertexFitter.h
+
+ Description: vertex fit of an opposite-sign track pair, with the fitting
+              strategy chosen once from the vertexFitter label
+
+ Implementation:
+     create() maps the label to one of
+       KalmanVertexFitter    : KalmanVertexFitter, smoothing on request
+       AdaptiveVertexFitter  : AdaptiveVertexFitter
+       AnalyticVertexFitter  : weighted mean of the two track points at
+                               the crossing point, with chi2 from their
+                               distance (1 degree of freedom)
+     and returns a null pointer for any other label (no vertex fit). The
+     instance is kept by the fitter and reused for every pair; concurrent
+     tasks use their own clone().
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__PAIR_VERTEX_FITTER_H
+#define VertexCompositeAnalysis__PAIR_VERTEX_FITTER_H
+
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+#include "TrackingTools/TrajectoryState/interface/TrajectoryStateClosestToPoint.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class PairVertexFitter {
+ public:
+  virtual ~PairVertexFitter() {}
+
+  // posTSCP and negTSCP are the track states at the crossing point
+  virtual TransientVertex vertex(const std::vector<reco::TransientTrack>& theTracks,
+                                 const TrajectoryStateClosestToPoint& posTSCP,
+                                 const TrajectoryStateClosestToPoint& negTSCP) const = 0;
+
+  virtual PairVertexFitter* clone() const = 0;
+
+  // true if the vertices can carry refitted tracks
+  virtual bool providesRefittedTracks() const { return false; }
+
+  static std::unique_ptr<PairVertexFitter> create(const std::string& label, bool useRefTrax);
+};
+
+#endif
@@ -0,0 +1,72 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      PreselectedTrackProducer
+// 
+/**\class PreselectedTrackProducer PreselectedTrackProducer.h VertexCompositeAnalysis/VertexCompositeProducer/interface/PreselectedTrackProducer.h
+
+ Description: table of the tracks passing a loose preselection, shared by
+              the candidate producers of one path
+
+ Implementation:
+     Applies the track quality, chi2, hits, pT error, pT, eta and impact
+     parameter significance cuts of the fitters once per event, with the
+     same best vertex (primary vertex, or beam spot if none). The products
+     are the TrackRefs of the passing tracks and, in the same order, their
+     transverse and longitudinal impact parameter significances, plus the
+     best vertex position and errors used for them ("bestVertex"). Nothing
+     else of the tracks is copied.
+
+     The fitters read the table with their preselectedTracks parameter
+     instead of looping over the whole track collection, and only compare
+     their own cut values with it (see TrackPreselection). The cuts here
+     therefore have to be the loosest of the modules reading the table, and
+     trackRecoAlgorithm and vertexRecoAlgorithm the ones of the fitters.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__PRESELECTED_TRACK_PRODUCER_H
+#define VertexCompositeAnalysis__PRESELECTED_TRACK_PRODUCER_H
+
+// system include files
+#include <memory>
+#include <vector>
+
+// user include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/EDProducer.h"
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "DataFormats/BeamSpot/interface/BeamSpot.h"
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPreselection.h"
+
+class PreselectedTrackProducer : public edm::EDProducer {
+public:
+  using SignificanceCollection = TrackPreselection::SignificanceCollection;
+
+  explicit PreselectedTrackProducer(const edm::ParameterSet&);
+  ~PreselectedTrackProducer();
+
+private:
+  virtual void beginJob();
+  virtual void produce(edm::Event&, const edm::EventSetup&);
+  virtual void endJob() ;
+
+  edm::EDGetTokenT<reco::TrackCollection> token_tracks;
+  edm::EDGetTokenT<reco::VertexCollection> token_vertices;
+  edm::EDGetTokenT<reco::BeamSpot> token_beamSpot;
+
+  TrackPreselection::Cuts theCuts;
+};
+
+#endif
@@ -0,0 +1,62 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      PreselectedTrackStore
+//
+/**\class PreselectedTrackStore PreselectedTrackStore.h VertexCompositeAnalysis/VertexCompositeProducer/interface/PreselectedTrackStore.h
+
+ Description: per-event store of the preselected tracks of one charge
+
+ Implementation:
+     Owns the TrackRefs and TransientTracks of the tracks passing the
+     preselection, together with their impact-point states and transverse
+     circles, in the same order. The fitter keeps one store per charge as
+     a member and clears it at the start of every event, so the buffers
+     keep their capacity, and the combinatorics only read the stores
+     through const references. fillStates() is called once all tracks are
+     in, so the states of a list are computed once per event however many
+     charge combinations use it.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__PRESELECTED_TRACK_STORE_H
+#define VertexCompositeAnalysis__PRESELECTED_TRACK_STORE_H
+
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackStateTable.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/HelixDCAPrefilter.h"
+
+#include <vector>
+
+class PreselectedTrackStore {
+ public:
+  PreselectedTrackStore() {}
+
+  void clear();
+
+  // Append the next preselected track
+  void push_back(const reco::TrackRef& theRef, const reco::TransientTrack& theTransTrack);
+
+  // Impact-point states and circles of all tracks, once the store is filled
+  void fillStates();
+
+  unsigned int size() const { return theRefs.size(); }
+
+  const reco::TrackRef& ref(unsigned int indx) const { return theRefs[indx]; }
+  const reco::TransientTrack& transTrack(unsigned int indx) const { return theTransTracks[indx]; }
+
+  const TrackStateTable& states() const { return theStates; }
+  const HelixDCAPrefilter& circles() const { return theCircles; }
+
+ private:
+  std::vector<reco::TrackRef> theRefs;
+  std::vector<reco::TransientTrack> theTransTracks;
+  TrackStateTable theStates;
+  HelixDCAPrefilter theCircles;
+};
+
+#endif
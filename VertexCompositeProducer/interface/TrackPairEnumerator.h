@@ -0,0 +1,70 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      TrackPairEnumerator
+//
+/**\class TrackPairEnumerator TrackPairEnumerator.h VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPairEnumerator.h
+
+ Description: charge-partitioned, momentum-sorted enumeration of
+              opposite-sign track pairs
+
+ Implementation:
+     Preselected tracks are split into positive and negative lists, each
+     sorted by momentum magnitude. For every equal-mass daughter hypothesis
+     with a pair-mass window [mMin, mMax] the admissible momenta of the
+     negative partner form a single interval: with p = m*sinh(y) the
+     smallest pair mass (collinear tracks) is 2m*cosh((y1-y2)/2) and the
+     largest one (back-to-back tracks) is 2m*cosh((y1+y2)/2). The partner
+     range of a positive track is therefore a contiguous slice of the
+     sorted negative list and is found by binary search. The momentum
+     magnitude is conserved along the helix, so the bounds hold for the
+     momenta evaluated at the crossing point as well.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__TRACK_PAIR_ENUMERATOR_H
+#define VertexCompositeAnalysis__TRACK_PAIR_ENUMERATOR_H
+
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+
+#include <vector>
+#include <utility>
+
+class TrackPairEnumerator {
+ public:
+  TrackPairEnumerator();
+
+  // Requires m(pair) in [mMin, mMax] with both daughters of mass dauMass.
+  // Several windows can be added, a pair has to pass all of them.
+  void addMassWindow(double dauMass, double mMin, double mMax);
+
+  // Partition and sort the preselected tracks (indices refer to the input vector)
+  void fill(const std::vector<reco::TrackRef>& theTrackRefs);
+  void clear();
+
+  const std::vector<unsigned int>& positives() const { return thePositives; }
+  const std::vector<unsigned int>& negatives() const { return theNegatives; }
+
+  // [first, second) range in negatives() of the partners of positives()[iPos]
+  std::pair<unsigned int, unsigned int> partners(unsigned int iPos) const;
+
+ private:
+  struct MassWindow {
+    double mass;
+    double maxRapDiff;   // |y1-y2| <= maxRapDiff
+    double minRapSum;    // y1+y2 >= minRapSum
+    bool   hasMinSum;
+    bool   isEmpty;
+  };
+
+  std::vector<MassWindow> theWindows;
+
+  std::vector<unsigned int> thePositives;
+  std::vector<unsigned int> theNegatives;
+  std::vector<double> thePosMomenta;
+  std::vector<double> theNegMomenta;
+};
+
+#endif
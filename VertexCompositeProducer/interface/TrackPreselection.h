@@ -0,0 +1,192 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      TrackPreselection
+//
+/**\class TrackPreselection TrackPreselection.h VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPreselection.h
+
+ Description: track quality, kinematic and impact parameter cuts shared by
+              the fitters and PreselectedTrackProducer
+
+ Implementation:
+     Without a table the cuts are applied to every track of the
+     trackRecoAlgorithm collection and the impact parameter significances
+     are computed with respect to the best vertex of the fitter.
+
+     With the optional preselectedTracks parameter the fitter reads the
+     table of PreselectedTrackProducer instead: the TrackRefs of the tracks
+     that passed looser cuts, and their significances, in the same order.
+     Only the cut values are then compared, the significances are not
+     recomputed. They are stored in double precision, so the selected
+     tracks are the same as without the table as long as the producer cuts
+     are looser. The table carries nothing else: the helix parameters,
+     errors, charge and PID still come from the tracks behind the refs.
+
+     select() throws if the table refers to another track collection than
+     trackRecoAlgorithm, or if the best vertex the producer computed the
+     significances with is not the one of the fitter.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__TRACK_PRESELECTION_H
+#define VertexCompositeAnalysis__TRACK_PRESELECTION_H
+
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/ConsumesCollector.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Math/interface/Point3D.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include "FWCore/Utilities/interface/EDMException.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+class TrackPreselection {
+ public:
+  using SignificanceCollection = std::vector<double>;
+
+  // The pT error and eta cuts are not applied while they are infinite
+  struct Cuts {
+    Cuts() : chi2Cut(std::numeric_limits<double>::infinity()), nhitsCut(0),
+             ptErrCut(std::numeric_limits<double>::infinity()), ptCut(-1.),
+             etaCut(std::numeric_limits<double>::infinity()),
+             transImpactSigCut(-1.), longImpactSigCut(-1.) {}
+
+    std::vector<reco::TrackBase::TrackQuality> qualities;
+    double chi2Cut;
+    int    nhitsCut;
+    double ptErrCut;
+    double ptCut;
+    double etaCut;
+    double transImpactSigCut;
+    double longImpactSigCut;
+
+    bool passTrack(const reco::Track& theTrack) const {
+      bool quality_ok = true;
+      if (qualities.size()!=0) {
+        quality_ok = false;
+        for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
+          if (theTrack.quality(qualities[ndx_])){
+            quality_ok = true;
+            break;
+          }
+        }
+      }
+      if( !quality_ok ) return false;
+
+      if( !(theTrack.normalizedChi2() < chi2Cut &&
+            theTrack.numberOfValidHits() >= nhitsCut &&
+            theTrack.pt() > ptCut) ) return false;
+      if( !std::isinf(ptErrCut) && !(theTrack.ptError() / theTrack.pt() < ptErrCut) ) return false;
+      if( !std::isinf(etaCut) && !(fabs(theTrack.eta()) < etaCut) ) return false;
+      return true;
+    }
+    bool passImpact(double transImpactSig, double longImpactSig) const {
+      return fabs(transImpactSig) > transImpactSigCut && fabs(longImpactSig) > longImpactSigCut;
+    }
+  };
+
+  TrackPreselection() : useTable(false) {}
+
+  // Reads the optional preselectedTracks parameter
+  void setup(const edm::ParameterSet& theParameters, edm::ConsumesCollector& iC, const Cuts& cuts) {
+    theCuts = cuts;
+
+    useTable = false;
+    if(theParameters.exists("preselectedTracks")) {
+      const edm::InputTag preselectedTracks = theParameters.getParameter<edm::InputTag>("preselectedTracks");
+      useTable = !preselectedTracks.label().empty();
+      if(useTable) {
+        token_tracks = iC.consumes<reco::TrackRefVector>(preselectedTracks);
+        token_transImpactSig = iC.consumes<SignificanceCollection>(
+          edm::InputTag(preselectedTracks.label(), std::string("dauTransImpactSig"), preselectedTracks.process()));
+        token_longImpactSig = iC.consumes<SignificanceCollection>(
+          edm::InputTag(preselectedTracks.label(), std::string("dauLongImpactSig"), preselectedTracks.process()));
+        token_bestVertex = iC.consumes<SignificanceCollection>(
+          edm::InputTag(preselectedTracks.label(), std::string("bestVertex"), preselectedTracks.process()));
+      }
+    }
+  }
+
+  // Significances of the transverse and longitudinal impact parameters
+  //  with respect to bestvtx
+  static void impactSignificances(const reco::Track& theTrack,
+                                  const math::XYZPoint& bestvtx, const math::XYZPoint& bestvtxError,
+                                  double& transImpactSig, double& longImpactSig) {
+    double dzvtx = theTrack.dz(bestvtx);
+    double dxyvtx = theTrack.dxy(bestvtx);
+    double dzerror = sqrt(theTrack.dzError()*theTrack.dzError()+bestvtxError.z()*bestvtxError.z());
+    double dxyerror = sqrt(theTrack.d0Error()*theTrack.d0Error()+bestvtxError.x()*bestvtxError.y());
+
+    longImpactSig = dzvtx/dzerror;
+    transImpactSig = dxyvtx/dxyerror;
+  }
+
+  // Replaces theSelected by the tracks passing the cuts, in collection order
+  void select(const edm::Event& iEvent, const edm::Handle<reco::TrackCollection>& theTrackHandle,
+              const math::XYZPoint& bestvtx, const math::XYZPoint& bestvtxError,
+              std::vector<reco::TrackRef>& theSelected) const {
+    theSelected.clear();
+
+    if( useTable ) {
+      edm::Handle<reco::TrackRefVector> theTableHandle;
+      edm::Handle<SignificanceCollection> theTransImpactSigHandle;
+      edm::Handle<SignificanceCollection> theLongImpactSigHandle;
+      edm::Handle<SignificanceCollection> theBestVertexHandle;
+      iEvent.getByToken(token_tracks, theTableHandle);
+      iEvent.getByToken(token_transImpactSig, theTransImpactSigHandle);
+      iEvent.getByToken(token_longImpactSig, theLongImpactSigHandle);
+      iEvent.getByToken(token_bestVertex, theBestVertexHandle);
+
+      const reco::TrackRefVector& theTable = *theTableHandle;
+      if( !theTable.empty() && theTable.id() != theTrackHandle.id() ) {
+        throw edm::Exception(edm::errors::Configuration)
+          << "TrackPreselection: the preselectedTracks table refers to product " << theTable.id()
+          << ", not to the trackRecoAlgorithm collection " << theTrackHandle.id() << "\n";
+      }
+      const SignificanceCollection& producerVtx = *theBestVertexHandle;
+      if( producerVtx.size() != 6 ||
+          producerVtx[0] != bestvtx.x() || producerVtx[1] != bestvtx.y() || producerVtx[2] != bestvtx.z() ||
+          producerVtx[3] != bestvtxError.x() || producerVtx[4] != bestvtxError.y() || producerVtx[5] != bestvtxError.z() ) {
+        throw edm::Exception(edm::errors::Configuration)
+          << "TrackPreselection: the preselectedTracks significances were computed with another best vertex"
+          << " than the one of vertexRecoAlgorithm\n";
+      }
+
+      const SignificanceCollection& transImpactSigs = *theTransImpactSigHandle;
+      const SignificanceCollection& longImpactSigs = *theLongImpactSigHandle;
+      for(unsigned int indx = 0; indx < theTable.size(); indx++) {
+        const reco::TrackRef tmpRef = theTable[indx];
+        if( theCuts.passTrack(*tmpRef) && theCuts.passImpact(transImpactSigs[indx], longImpactSigs[indx]) ) {
+          theSelected.push_back(tmpRef);
+        }
+      }
+      return;
+    }
+
+    for(unsigned int indx = 0; indx < theTrackHandle->size(); indx++) {
+      reco::TrackRef tmpRef( theTrackHandle, indx );
+      if( !theCuts.passTrack(*tmpRef) ) continue;
+
+      double transImpactSig, longImpactSig;
+      impactSignificances(*tmpRef, bestvtx, bestvtxError, transImpactSig, longImpactSig);
+      if( theCuts.passImpact(transImpactSig, longImpactSig) ) theSelected.push_back(tmpRef);
+    }
+  }
+
+ private:
+  Cuts theCuts;
+
+  bool useTable;
+  edm::EDGetTokenT<reco::TrackRefVector> token_tracks;
+  edm::EDGetTokenT<SignificanceCollection> token_transImpactSig;
+  edm::EDGetTokenT<SignificanceCollection> token_longImpactSig;
+  edm::EDGetTokenT<SignificanceCollection> token_bestVertex;
+};
+
+#endif
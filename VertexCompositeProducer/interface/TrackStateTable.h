@@ -0,0 +1,53 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      TrackStateTable
+//
+/**\class TrackStateTable TrackStateTable.h VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackStateTable.h
+
+ Description: per-event table of impact-point track states
+
+ Implementation:
+     Filled once per preselected track, in the same order as the
+     TransientTrack vector of the fitter. The impact-point state, its
+     momentum and the track charge are stored in contiguous columns so
+     the pair loops read them by index instead of re-evaluating
+     impactPointTSCP() for every pair a track takes part in.
+*/
+//
+//
+
+#ifndef VertexCompositeAnalysis__TRACK_STATE_TABLE_H
+#define VertexCompositeAnalysis__TRACK_STATE_TABLE_H
+
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+#include "TrackingTools/TrajectoryState/interface/FreeTrajectoryState.h"
+#include "DataFormats/GeometryVector/interface/GlobalVector.h"
+
+#include <vector>
+
+class TrackStateTable {
+ public:
+  TrackStateTable() {}
+
+  void clear();
+  void reserve(unsigned int n);
+
+  // Append the impact-point state of the next preselected track
+  void push_back(const reco::TransientTrack& theTransTrack);
+
+  unsigned int size() const { return theValid.size(); }
+
+  bool isValid(unsigned int indx) const { return theValid[indx]; }
+  const FreeTrajectoryState& state(unsigned int indx) const { return theStates[indx]; }
+  const GlobalVector& momentum(unsigned int indx) const { return theMomenta[indx]; }
+  int charge(unsigned int indx) const { return theCharges[indx]; }
+
+ private:
+  std::vector<FreeTrajectoryState> theStates;
+  std::vector<GlobalVector> theMomenta;
+  std::vector<int> theCharges;
+  std::vector<char> theValid;
+};
+
+#endif
@@ -61,8 +61,17 @@
 
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPairEnumerator.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackStateTable.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/HelixDCAPrefilter.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/MassHypothesisFilter.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/PairVertexFitter.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/DaughterTrackVeto.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPreselection.h"
+
 #include <string>
 #include <fstream>
+#include <memory>
 
 class V0Fitter {
  public:
@@ -84,6 +93,19 @@ class V0Fitter {
   const reco::VertexCompositeCandidateCollection& getDPM() const;
   const reco::VertexCompositeCandidateCollection& getLambdaCToLamPi() const;
   const reco::VertexCompositeCandidateCollection& getLambdaCToKsP() const;
+
+  // Hand the collections over to the caller, leaving them empty
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseKshorts();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releasePhis();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseLambdas();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseXis();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseOmegas();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseD0();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseDSToKsK();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseDSToPhiPi();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseDPM();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseLambdaCToLamPi();
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> releaseLambdaCToKsP();
   void resetAll();
 
  private:
@@ -126,6 +148,7 @@ class V0Fitter {
   bool doLambdaCToKsPs;
 
   bool doVertexFit;
+  bool parallelPairLoop;
 
   /*bool doPostFitCuts;
     bool doTkQualCuts;*/
@@ -168,7 +191,32 @@ class V0Fitter {
 
   std::vector<reco::TrackBase::TrackQuality> qualities;
 
+  TrackPreselection thePreselection;
+
+  // Opposite-sign pair enumeration restricted by the mPiPi/mKK windows
+  TrackPairEnumerator thePairEnumerator;
+  TrackStateTable theTrackStates;
+  HelixDCAPrefilter thePosCircles;
+  HelixDCAPrefilter theNegCircles;
+  MassHypothesisFilter<2> thePairMassFilter;
+
+  // bachelor tracks that are daughters of the current V0
+  DaughterTrackVeto theDaughterVeto;
+
   edm::InputTag vtxFitter;
+  // null if no vertex fit is requested
+  std::unique_ptr<PairVertexFitter> theVertexFitter;
+
+  // Candidates of the pair loop built around one positive track
+  struct PairCandidates {
+    reco::VertexCompositeCandidateCollection kshorts;
+    reco::VertexCompositeCandidateCollection phis;
+    reco::VertexCompositeCandidateCollection lambdas;
+    reco::VertexCompositeCandidateCollection d0s;
+  };
+
+  // Moves the buffered candidates to the end of the output collections
+  void appendPairCandidates(PairCandidates& theCandidates);
 
   // Helper method that does the actual fitting using the KalmanVertexFitter
   double findV0MassError(const GlobalPoint &vtxPos, std::vector<reco::TransientTrack> dauTracks);
@@ -5,6 +5,10 @@ generalBCandidates = cms.EDProducer("BProducer",
     # InputTag that tells which TrackCollection to use for vertexing
     trackRecoAlgorithm = cms.InputTag('generalTracks'),
     vertexRecoAlgorithm = cms.InputTag('offlinePrimaryVertices'),
+    # Optional PreselectedTrackProducer table of trackRecoAlgorithm tracks,
+    #  with looser cuts than below and the same vertexRecoAlgorithm. Empty
+    #  to loop over all tracks
+    preselectedTracks = cms.InputTag(''),
     d0RecoAlgorithm = cms.InputTag('generalD0CandidatesNew','D0'),
 
     trackQualities = cms.vstring('highPurity'),
@@ -39,7 +43,10 @@ generalBCandidates = cms.EDProducer("BProducer",
     bMassCut = cms.double(0.3),
     bPtCut = cms.double(0.0),
 
-    isWrongSignB = cms.bool(False)
+    isWrongSignB = cms.bool(False),
+    # right-sign candidates in 'B' and wrong-sign ones in 'BWS' from one
+    # pass, isWrongSignB is then ignored
+    produceBothSignsB = cms.bool(False)
 
 # MVA 
 #    useAnyMVA = cms.bool(False),
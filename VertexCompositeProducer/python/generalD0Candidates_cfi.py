@@ -5,6 +5,10 @@ generalD0Candidates = cms.EDProducer("D0Producer",
     # InputTag that tells which TrackCollection to use for vertexing
     trackRecoAlgorithm = cms.InputTag('generalTracks'),
     vertexRecoAlgorithm = cms.InputTag('offlinePrimaryVertices'),
+    # Optional PreselectedTrackProducer table of trackRecoAlgorithm tracks,
+    #  with looser cuts than below and the same vertexRecoAlgorithm. Empty
+    #  to loop over all tracks
+    preselectedTracks = cms.InputTag(''),
 
     trackQualities = cms.vstring('highPurity'),
                                      
@@ -39,6 +43,14 @@ generalD0Candidates = cms.EDProducer("D0Producer",
     dPtCut = cms.double(0.0),
 
     isWrongSign = cms.bool(False),
+    # right-sign candidates in 'D0' and wrong-sign ones in 'D0WS' from one
+    # pass, isWrongSign is then ignored
+    produceBothSigns = cms.bool(False),
+
+    # reuse the K-pi vertex fit for the pi-K hypothesis, refitting only
+    # pairs whose mass is within sharedFitEdgeMargin of a d0MassCut edge
+    sharedVertexFit = cms.bool(False),
+    sharedFitEdgeMargin = cms.double(0.002),
 
 # MVA 
 
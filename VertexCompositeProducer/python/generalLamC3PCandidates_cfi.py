@@ -5,6 +5,10 @@ generalLamC3PCandidates = cms.EDProducer("LamC3PProducer",
     # InputTag that tells which TrackCollection to use for vertexing
     trackRecoAlgorithm = cms.InputTag('generalTracks'),
     vertexRecoAlgorithm = cms.InputTag('offlinePrimaryVertices'),
+    # Optional PreselectedTrackProducer table of trackRecoAlgorithm tracks,
+    #  with looser cuts than below and the same vertexRecoAlgorithm. Empty
+    #  to loop over all tracks
+    preselectedTracks = cms.InputTag(''),
 
     trackQualities = cms.vstring('highPurity'),
                                      
@@ -42,6 +46,12 @@ generalLamC3PCandidates = cms.EDProducer("LamC3PProducer",
 
     isWrongSign = cms.bool(False),
 
+    # Process the first tracks of the triplet loop as parallel tasks of
+    #  pairLoopGrainSize tracks. The output collection is identical to the
+    #  serial one.
+    parallelPairLoop = cms.bool(False),
+    pairLoopGrainSize = cms.int32(1),
+
 # MVA 
 
     useAnyMVA = cms.bool(False),
@@ -5,6 +5,10 @@ generalV0Candidates = cms.EDProducer("V0Producer",
     # InputTag that tells which TrackCollection to use for vertexing
     trackRecoAlgorithm = cms.InputTag('generalTracks'),
     vertexRecoAlgorithm = cms.InputTag('offlinePrimaryVertices'),
+    # Optional PreselectedTrackProducer table of trackRecoAlgorithm tracks,
+    #  with looser cuts than below and the same vertexRecoAlgorithm. Empty
+    #  to loop over all tracks
+    preselectedTracks = cms.InputTag(''),
 
     # These bools decide whether or not to reconstruct
     #  specific V0 particles
@@ -22,7 +26,13 @@ generalV0Candidates = cms.EDProducer("V0Producer",
 
     doVertexFit = cms.bool(True),
 
+    # Process the positive tracks of the pair loop as parallel tasks.
+    #  The output collections are identical to the serial ones.
+    parallelPairLoop = cms.bool(False),
+
     # Recommend leaving this one as is.
+    #  'KalmanVertexFitter', 'AdaptiveVertexFitter' or 'AnalyticVertexFitter'
+    #  (fast weighted mean of the two tracks at their crossing point)
     vertexFitter = cms.InputTag('KalmanVertexFitter'),
 
     # set to true, uses tracks refit by the KVF for V0Candidate kinematics
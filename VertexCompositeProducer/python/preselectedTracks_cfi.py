@@ -0,0 +1,24 @@
+import FWCore.ParameterSet.Config as cms
+
+# Tracks passing the loosest preselection of the candidate producers, read by
+#  them through their preselectedTracks parameter. The cuts have to be looser
+#  than those of every module reading the table.
+preselectedTracks = cms.EDProducer("PreselectedTrackProducer",
+
+    # TrackCollection to preselect and vertices for the impact parameter
+    #  significances, the same as in the candidate producers
+    trackRecoAlgorithm = cms.InputTag('generalTracks'),
+    vertexRecoAlgorithm = cms.InputTag('offlinePrimaryVertices'),
+
+    trackQualities = cms.vstring(),
+
+    tkChi2Cut = cms.double(9999.0), #trk Chi2 <
+    tkNhitsCut = cms.int32(0), #trk Nhits >=
+    tkPtErrCut = cms.double(9999.0), #trk pT err <
+    tkPtCut = cms.double(0.0), #trk pT >
+    tkEtaCut = cms.double(999.0), #trk abs(eta) <
+
+    #   Track impact parameter significance >
+    dauTransImpactSigCut = cms.double(-1.),
+    dauLongImpactSigCut = cms.double(-1.),
+)
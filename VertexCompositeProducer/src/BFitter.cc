@@ -28,6 +28,7 @@
 #include "RecoVertex/KinematicFitPrimitives/interface/MultiTrackKinematicConstraint.h"
 #include "RecoVertex/KinematicFit/interface/KinematicConstrainedVertexFitter.h"
 #include "RecoVertex/KinematicFit/interface/TwoTrackMassKinematicConstraint.h"
+#include "RecoVertex/KinematicFitPrimitives/interface/VirtualKinematicParticleFactory.h"
 #include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
 
 #include "DataFormats/BeamSpot/interface/BeamSpot.h"
@@ -86,6 +87,19 @@ BFitter::BFitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollector
   bAlphaCut = theParameters.getParameter<double>(string("bAlphaCut"));
   bAlpha2DCut = theParameters.getParameter<double>(string("bAlpha2DCut"));
   isWrongSignB = theParameters.getParameter<bool>(string("isWrongSignB"));
+  produceBothSignsB = false;
+  if(theParameters.exists("produceBothSignsB")) produceBothSignsB = theParameters.getParameter<bool>("produceBothSignsB");
+
+  TrackPreselection::Cuts trackCuts;
+  trackCuts.qualities = qualities;
+  trackCuts.chi2Cut = batTkChi2Cut;
+  trackCuts.nhitsCut = batTkNhitsCut;
+  trackCuts.ptCut = batTkPtCut;
+  trackCuts.ptErrCut = batTkPtErrCut;
+  trackCuts.etaCut = batTkEtaCut;
+  trackCuts.transImpactSigCut = batDauTransImpactSigCut;
+  trackCuts.longImpactSigCut = batDauLongImpactSigCut;
+  thePreselection.setup(theParameters, iC, trackCuts);
 }
 
 BFitter::~BFitter() {
@@ -141,7 +155,7 @@ void BFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   double xVtxError=-999.0;
   double yVtxError=-999.0;
   double zVtxError=-999.0;
-  const reco::VertexCollection vtxCollection = *(theVertexHandle.product());
+  const reco::VertexCollection& vtxCollection = *(theVertexHandle.product());
   reco::VertexCollection::const_iterator vtxPrimary = vtxCollection.begin();
   if(vtxCollection.size()>0 && !vtxPrimary->isFake() && vtxPrimary->tracksSize()>=2)
   {
@@ -165,43 +179,19 @@ void BFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   math::XYZPoint bestvtx(xVtx,yVtx,zVtx);
 
   // Fill vectors of TransientTracks and TrackRefs after applying preselection cuts.
-  for(unsigned int indx = 0; indx < theTrackHandle->size(); indx++) {
-    TrackRef tmpRef( theTrackHandle, indx );
-    bool quality_ok = true;
-    if (qualities.size()!=0) {
-      quality_ok = false;
-      for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
-	if (tmpRef->quality(qualities[ndx_])){
-	  quality_ok = true;
-	  break;          
-	}
-      }
-    }
-    if( !quality_ok ) continue;
-
-    if( tmpRef->normalizedChi2() < batTkChi2Cut &&
-        tmpRef->numberOfValidHits() >= batTkNhitsCut &&
-        tmpRef->ptError() / tmpRef->pt() < batTkPtErrCut &&
-        tmpRef->pt() > batTkPtCut && fabs(tmpRef->eta()) < batTkEtaCut ) {
-//      TransientTrack tmpTk( *tmpRef, &(*bFieldHandle), globTkGeomHandle );
-      TransientTrack tmpTk( *tmpRef, magField );
-
-      double dzvtx = tmpRef->dz(bestvtx);
-      double dxyvtx = tmpRef->dxy(bestvtx);      
-      double dzerror = sqrt(tmpRef->dzError()*tmpRef->dzError()+zVtxError*zVtxError);
-      double dxyerror = sqrt(tmpRef->d0Error()*tmpRef->d0Error()+xVtxError*yVtxError);
-
-      double dauLongImpactSig = dzvtx/dzerror;
-      double dauTransImpactSig = dxyvtx/dxyerror;
-
-      if( fabs(dauTransImpactSig) > batDauTransImpactSigCut && fabs(dauLongImpactSig) > batDauLongImpactSigCut ) {
-        theTrackRefs.push_back( tmpRef );
-        theTransTracks.push_back( tmpTk );
-      }
-    }
+  std::vector<TrackRef> theSelectedTracks;
+  thePreselection.select(iEvent, theTrackHandle, bestvtx, math::XYZPoint(xVtxError,yVtxError,zVtxError), theSelectedTracks);
+  for(unsigned int indx = 0; indx < theSelectedTracks.size(); indx++) {
+    const TrackRef& tmpRef = theSelectedTracks[indx];
+    TransientTrack tmpTk( *tmpRef, magField );
+    theTrackRefs.push_back( tmpRef );
+    theTransTracks.push_back( tmpTk );
   }
 
-  const reco::VertexCompositeCandidateCollection theD0s = *(theD0Handle.product());
+  // the bachelors are vetoed against the D0 daughters by track key
+  theDaughterVeto.reset(theTrackHandle.id(), theTrackHandle->size());
+
+  const reco::VertexCompositeCandidateCollection& theD0s = *(theD0Handle.product());
   for(unsigned it=0; it<theD0s.size(); ++it){
 
     const reco::VertexCompositeCandidate & theD0 = theD0s[it];
@@ -220,11 +210,7 @@ void BFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
     for(unsigned int j = 0; j < d0daughters.size(); ++j) {
       theDaughterTracks.push_back(d0daughters[j].track());
     }
-
-    vector<TransientTrack> tracksForKalmanFit;
-    for (unsigned int ndx = 0; ndx < theDaughterTracks.size(); ndx++) {
-        tracksForKalmanFit.push_back(TransientTrack(theDaughterTracks[ndx], &(*bFieldHandle)));
-    }
+    theDaughterVeto.setDaughters(theDaughterTracks);
 
     vector<float> d0DauMasses;
     vector<float> d0DauMasses_sigma;
@@ -240,21 +226,70 @@ void BFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
       d0DauMasses_sigma.push_back(piMassB_sigma);
     }
 
+    // D0 vertex fit with the D0 mass constraint. It does not depend on the
+    //  bachelor, so it is done once, when the first bachelor passes the
+    //  preselection, and shared by all the B fits of this D0. The fit tree
+    //  is kept alive as long as its particle and vertex are used.
+    bool d0Fitted = false;
+    bool d0FitValid = false;
+    RefCountedKinematicTree d0VertexFitTree;
+    RefCountedKinematicParticle d0_vFit_withMC;
+    RefCountedKinematicVertex d0_vFit_vertex;
+
+    auto fitD0 = [&]() -> bool {
+      TransientTrack dauPos(theDaughterTracks[0], &(*bFieldHandle) );
+      TransientTrack dauNeg(theDaughterTracks[1], &(*bFieldHandle) );
+
+      if (!dauPos.isValid()) return false;
+      if (!dauNeg.isValid()) return false;
+
+      //Creating a KinematicParticleFactory
+      KinematicParticleFactoryFromTransientTrack pFactory;
+
+      float chi = 0.;
+      float ndf = 0.;
+      vector<RefCountedKinematicParticle> d0Particles;
+      d0Particles.push_back(pFactory.particle(dauPos,d0DauMasses[0],chi,ndf,d0DauMasses_sigma[0]));
+      d0Particles.push_back(pFactory.particle(dauNeg,d0DauMasses[1],chi,ndf,d0DauMasses_sigma[1]));
+
+      KinematicParticleVertexFitter fitter;
+      d0VertexFitTree = fitter.fit(d0Particles);
+      if (!d0VertexFitTree->isValid()) return false;
+
+      d0VertexFitTree->movePointerToTheTop();
+
+      RefCountedKinematicParticle d0_vFit = d0VertexFitTree->currentParticle();
+      d0_vFit_vertex = d0VertexFitTree->currentDecayVertex();
+
+      d0VertexFitTree->movePointerToTheFirstChild();
+      RefCountedKinematicParticle d0Pi1 = d0VertexFitTree->currentParticle();
+      d0VertexFitTree->movePointerToTheNextChild();
+      RefCountedKinematicParticle d0Pi2 = d0VertexFitTree->currentParticle();
+
+      // now apply D0 mass constraint
+      KinematicParticleFitter csFitterD0;
+      KinematicConstraint * bmeson = new MassKinematicConstraint(d0MassB,d0MassB_sigma);
+
+      d0VertexFitTree->movePointerToTheTop();
+      d0VertexFitTree = csFitterD0.fit(bmeson,d0VertexFitTree);
+      if (!d0VertexFitTree->isValid()) return false;
+      d0VertexFitTree->movePointerToTheTop();
+      d0_vFit_withMC = d0VertexFitTree->currentParticle();
+
+      if (!d0_vFit_withMC->currentState().isValid()) return false;
+      return true;
+    };
+
     for(unsigned int trdx = 0; trdx < theTrackRefs.size(); trdx++) {
 
        if ( theTrackRefs[trdx].isNull() ) continue;
 
-       if(isWrongSignB && theTrackRefs[trdx]->charge()*theD0.pdgId()<0) continue;
-       if(!isWrongSignB && theTrackRefs[trdx]->charge()*theD0.pdgId()>0) continue;
+       // pion charge of the same sign as the D0 flavour is wrong-sign
+       const bool batIsWrongSign = theTrackRefs[trdx]->charge()*theD0.pdgId()>0;
+       if(!produceBothSignsB && isWrongSignB && !batIsWrongSign) continue;
+       if(!produceBothSignsB && !isWrongSignB && batIsWrongSign) continue;
 
-       bool match = false;
-
-       for(unsigned int j = 0; j < theDaughterTracks.size(); ++j) {
-         if (theTrackRefs[trdx]->charge() == theDaughterTracks[j]->charge() &&
-             theTrackRefs[trdx]->momentum() == theDaughterTracks[j]->momentum() ) match = true;
-         if (match) break;
-       }
-       if (match) continue; // Track is already used in making the D0
+       if ( theDaughterVeto.isDaughter(theTrackRefs[trdx]) ) continue; // Track is already used in making the D0
 
        // pre-selections on B invariant mass and pT to save time
        double ETotPre = sqrt(theTrackRefs[trdx]->momentum().mag2()+piMassBSquared) + theD0.energy(); 
@@ -265,54 +300,33 @@ void BFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
        if(massPre > mPiDCutMax || massPre < mPiDCutMin) continue;
        if(totalPt < bPtCut ) continue;
 
-       TransientTrack dauPos(theDaughterTracks[0], &(*bFieldHandle) );
-       TransientTrack dauNeg(theDaughterTracks[1], &(*bFieldHandle) );
-       TransientTrack batDau(theTrackRefs[trdx], &(*bFieldHandle) );
-
-       if (!dauPos.isValid()) continue;
-       if (!dauNeg.isValid()) continue;
+       // the preselected TransientTrack of the bachelor
+       const TransientTrack& batDau = theTransTracks[trdx];
        if (!batDau.isValid()) continue;
 
+       if( !d0Fitted ) {
+         d0FitValid = fitD0();
+         d0Fitted = true;
+       }
+       if( !d0FitValid ) continue;
+
        //Creating a KinematicParticleFactory
        KinematicParticleFactoryFromTransientTrack pFactory;
 
        float chi = 0.;
        float ndf = 0.;
-       vector<RefCountedKinematicParticle> d0Particles;
-       d0Particles.push_back(pFactory.particle(dauPos,d0DauMasses[0],chi,ndf,d0DauMasses_sigma[0]));
-       d0Particles.push_back(pFactory.particle(dauNeg,d0DauMasses[1],chi,ndf,d0DauMasses_sigma[1]));
-
        KinematicParticleVertexFitter fitter;
-       RefCountedKinematicTree d0VertexFitTree;
-       d0VertexFitTree = fitter.fit(d0Particles);
-       if (!d0VertexFitTree->isValid()) continue;
-
-       d0VertexFitTree->movePointerToTheTop();
-
-       RefCountedKinematicParticle d0_vFit = d0VertexFitTree->currentParticle();
-       RefCountedKinematicVertex d0_vFit_vertex = d0VertexFitTree->currentDecayVertex();
-
-       d0VertexFitTree->movePointerToTheFirstChild();
-       RefCountedKinematicParticle d0Pi1 = d0VertexFitTree->currentParticle();
-       d0VertexFitTree->movePointerToTheNextChild();
-       RefCountedKinematicParticle d0Pi2 = d0VertexFitTree->currentParticle();
-
-       // now apply D0 mass constraint
-       KinematicParticleFitter csFitterD0;
-       KinematicConstraint * bmeson = new MassKinematicConstraint(d0MassB,d0MassB_sigma);
-
-       d0VertexFitTree->movePointerToTheTop();
-       d0VertexFitTree = csFitterD0.fit(bmeson,d0VertexFitTree);
-       if (!d0VertexFitTree->isValid()) continue;
-       d0VertexFitTree->movePointerToTheTop();
-       RefCountedKinematicParticle d0_vFit_withMC = d0VertexFitTree->currentParticle();
-
-       if (!d0_vFit_withMC->currentState().isValid()) continue;
 
        vector<RefCountedKinematicParticle> bFitParticles;
 
        bFitParticles.push_back(pFactory.particle(batDau,piMassB,chi,ndf,piMassB_sigma));
-       bFitParticles.push_back(d0_vFit_withMC);
+       // The vertex fitter attaches the tree of a virtual input particle to
+       //  the tree it builds, so every B fit gets its own particle with the
+       //  constrained D0 state instead of the shared one.
+       VirtualKinematicParticleFactory vFactory;
+       float d0Chi2 = d0_vFit_withMC->chiSquared();
+       float d0Ndf = d0_vFit_withMC->degreesOfFreedom();
+       bFitParticles.push_back(vFactory.particle(d0_vFit_withMC->currentState(),d0Chi2,d0Ndf,d0_vFit_withMC));
 
        //fit B
        RefCountedKinematicTree bFitTree = fitter.fit(bFitParticles);
@@ -415,7 +429,10 @@ void BFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
        addp4.set( *theB );
 
        if( theB->mass() < bMassB + bMassCut &&
-           theB->mass() > bMassB - bMassCut ) theBs.push_back( *theB );
+           theB->mass() > bMassB - bMassCut ) {
+         if(produceBothSignsB && batIsWrongSign) theBsWS.push_back( *theB );
+         else theBs.push_back( *theB );
+       }
        if(theB) delete theB;
           theB = 0;
     }
@@ -432,6 +449,18 @@ const std::vector<float>& BFitter::getMVAVals() const {
   return mvaVals_;
 }
 */
+std::unique_ptr<reco::VertexCompositeCandidateCollection> BFitter::releaseB() {
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+  theReleased->swap(theBs);
+  return theReleased;
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> BFitter::releaseBWS() {
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+  theReleased->swap(theBsWS);
+  return theReleased;
+}
+
 /*
 auto_ptr<edm::ValueMap<float> > BFitter::getMVAMap() const {
   return mvaValValueMap;
@@ -440,5 +469,6 @@ auto_ptr<edm::ValueMap<float> > BFitter::getMVAMap() const {
 
 void BFitter::resetAll() {
     theBs.clear();
+    theBsWS.clear();
 //    mvaVals_.clear();
 }
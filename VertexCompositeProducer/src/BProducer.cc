@@ -29,7 +29,11 @@ BProducer::BProducer(const edm::ParameterSet& iConfig) :
 //  useAnyMVA_ = false;
 //  if(iConfig.exists("useAnyMVA")) useAnyMVA_ = iConfig.getParameter<bool>("useAnyMVA");
  
+  produceBothSignsB_ = false;
+  if(iConfig.exists("produceBothSignsB")) produceBothSignsB_ = iConfig.getParameter<bool>("produceBothSignsB");
+
   produces< reco::VertexCompositeCandidateCollection >("B");
+  if(produceBothSignsB_) produces< reco::VertexCompositeCandidateCollection >("BWS");
 //  if(useAnyMVA_) produces<MVACollection>("MVAValuesB");
 }
 
@@ -55,15 +59,15 @@ void BProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
 //   std::auto_ptr< reco::VertexCompositeCandidateCollection >
 //     bCandidates( new reco::VertexCompositeCandidateCollection );
 //
-   auto bCandidates = std::make_unique<reco::VertexCompositeCandidateCollection>();
-   bCandidates->reserve( theVees.getB().size() );
-
-   std::copy( theVees.getB().begin(),
-              theVees.getB().end(),
-              std::back_inserter(*bCandidates) );
+   auto bCandidates = theVees.releaseB();
 
    // Write the collections to the Event
    iEvent.put( std::move(bCandidates), std::string("B") );
+   if(produceBothSignsB_)
+   {
+     auto bWSCandidates = theVees.releaseBWS();
+     iEvent.put( std::move(bWSCandidates), std::string("BWS") );
+   }
 /*    
    if(useAnyMVA_) 
    {
@@ -41,6 +41,34 @@
 #include "CommonTools/Statistics/interface/ChiSquaredProbability.h"
 #include "CondFormats/DataRecord/interface/GBRWrapperRcd.h"
 
+namespace {
+  // Track pair that passed the DCA cut, with the daughter states at the
+  //  crossing point
+  struct PairSeed {
+    unsigned int posIndx;
+    unsigned int negIndx;
+    bool isWrongSign;
+    TrajectoryStateClosestToPoint posTSCP;
+    TrajectoryStateClosestToPoint negTSCP;
+  };
+
+  // Pair mass for the given daughter mass assignment, from the daughter
+  //  momenta refitted to the common vertex. Negative if a daughter is invalid.
+  double refitPairMass(const RefCountedKinematicTree& d0Vertex, double posMass, double negMass) {
+    d0Vertex->movePointerToTheFirstChild();
+    RefCountedKinematicParticle posCand = d0Vertex->currentParticle();
+    d0Vertex->movePointerToTheNextChild();
+    RefCountedKinematicParticle negCand = d0Vertex->currentParticle();
+    d0Vertex->movePointerToTheTop();
+    if(!posCand->currentState().isValid() || !negCand->currentState().isValid()) return -1.;
+
+    const GlobalVector posP = posCand->currentState().globalMomentum();
+    const GlobalVector negP = negCand->currentState().globalMomentum();
+    const double totalE = sqrt( posP.mag2() + posMass*posMass ) + sqrt( negP.mag2() + negMass*negMass );
+    return sqrt( totalE*totalE - (posP + negP).mag2() );
+  }
+}
+
 const float piMassD0 = 0.13957018;
 const float piMassD0Squared = piMassD0*piMassD0;
 const float kaonMassD0 = 0.493677;
@@ -87,6 +115,16 @@ D0Fitter::D0Fitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollect
   alphaCut = theParameters.getParameter<double>(string("alphaCut"));
   alpha2DCut = theParameters.getParameter<double>(string("alpha2DCut"));
   isWrongSign = theParameters.getParameter<bool>(string("isWrongSign"));
+  //  -right-sign and wrong-sign pairs from the same enumeration, the
+  //     wrong-sign candidates go to a separate collection
+  produceBothSigns = false;
+  if(theParameters.exists("produceBothSigns")) produceBothSigns = theParameters.getParameter<bool>("produceBothSigns");
+  //  -whether the second mass hypothesis reuses the vertex fit of the first,
+  //     and how close to the mass window edges it is refit anyway
+  sharedVertexFit = false;
+  if(theParameters.exists("sharedVertexFit")) sharedVertexFit = theParameters.getParameter<bool>("sharedVertexFit");
+  sharedFitEdgeMargin = 0.002;
+  if(theParameters.exists("sharedFitEdgeMargin")) sharedFitEdgeMargin = theParameters.getParameter<double>("sharedFitEdgeMargin");
 
 
   useAnyMVA_ = false;
@@ -96,6 +134,8 @@ D0Fitter::D0Fitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollect
   dbFileName_ = "";
 
   forest_ = nullptr;
+  dbForest_ = nullptr;
+  forestLookups_ = 0;
 
   if(theParameters.exists("useAnyMVA")) useAnyMVA_ = theParameters.getParameter<bool>("useAnyMVA");
 
@@ -112,7 +152,10 @@ D0Fitter::D0Fitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollect
       TFile gbrfile(fip.fullPath().c_str(),"READ");
       forest_ = (GBRForest*)gbrfile.Get(forestLabel_.c_str());
       gbrfile.Close();
+      if(forest_) flatForest_.build(*forest_);
+      compiledForest_ = CompiledGBRForest::find(fip.relativePath(), forestLabel_);
     }
+    mvaFeatures_.setNVars(20);
 
     mvaType_ = type;
   }
@@ -121,6 +164,24 @@ D0Fitter::D0Fitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollect
   for (unsigned int ndx = 0; ndx < qual.size(); ndx++) {
     qualities.push_back(reco::TrackBase::qualityByName(qual[ndx]));
   }
+
+  TrackPreselection::Cuts trackCuts;
+  trackCuts.qualities = qualities;
+  trackCuts.chi2Cut = tkChi2Cut;
+  trackCuts.nhitsCut = tkNhitsCut;
+  trackCuts.ptCut = tkPtCut;
+  trackCuts.ptErrCut = tkPtErrCut;
+  trackCuts.etaCut = tkEtaCut;
+  trackCuts.transImpactSigCut = dauTransImpactSigCut;
+  trackCuts.longImpactSigCut = dauLongImpactSigCut;
+  thePreselection.setup(theParameters, iC, trackCuts);
+
+  // positive kaon or positive pion, either one has to fall in the window
+  const float kPiMassesSquared[2] = {kaonMassD0Squared, piMassD0Squared};
+  const float piKMassesSquared[2] = {piMassD0Squared, kaonMassD0Squared};
+  thePairMassFilter.setRequireAll(false);
+  thePairMassFilter.addHypothesis(kPiMassesSquared, mPiKCutMin, mPiKCutMax);
+  thePairMassFilter.addHypothesis(piKMassesSquared, mPiKCutMin, mPiKCutMax);
 }
 
 D0Fitter::~D0Fitter() {
@@ -165,6 +226,15 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
 
   magField = bFieldHandle.product();
 
+  // the forest from the DB is only looked up again when its IOV changes
+  if(useAnyMVA_ && useForestFromDB_ && forestWatcher_.check(iSetup)){
+    edm::ESHandle<GBRForest> forestHandle;
+    iSetup.get<GBRWrapperRcd>().get(forestLabel_,forestHandle);
+    dbForest_ = forestHandle.product();
+    flatForest_.build(*dbForest_);
+    forestLookups_++;
+  }
+
   // Setup TMVA
 //  mvaValValueMap = auto_ptr<edm::ValueMap<float> >(new edm::ValueMap<float>);
 //  edm::ValueMap<float>::Filler mvaFiller(*mvaValValueMap);
@@ -176,7 +246,7 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   double xVtxError=-999.0;
   double yVtxError=-999.0;
   double zVtxError=-999.0;
-  const reco::VertexCollection vtxCollection = *(theVertexHandle.product());
+  const reco::VertexCollection& vtxCollection = *(theVertexHandle.product());
   reco::VertexCollection::const_iterator vtxPrimary = vtxCollection.begin();
   if(vtxCollection.size()>0 && !vtxPrimary->isFake() && vtxPrimary->tracksSize()>=2)
   {
@@ -200,40 +270,20 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   math::XYZPoint bestvtx(xVtx,yVtx,zVtx);
 
   // Fill vectors of TransientTracks and TrackRefs after applying preselection cuts.
-  for(unsigned int indx = 0; indx < theTrackHandle->size(); indx++) {
-    TrackRef tmpRef( theTrackHandle, indx );
-    bool quality_ok = true;
-    if (qualities.size()!=0) {
-      quality_ok = false;
-      for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
-	if (tmpRef->quality(qualities[ndx_])){
-	  quality_ok = true;
-	  break;          
-	}
-      }
-    }
-    if( !quality_ok ) continue;
-
-    if( tmpRef->normalizedChi2() < tkChi2Cut &&
-        tmpRef->numberOfValidHits() >= tkNhitsCut &&
-        tmpRef->ptError() / tmpRef->pt() < tkPtErrCut &&
-        tmpRef->pt() > tkPtCut && fabs(tmpRef->eta()) < tkEtaCut ) {
-//      TransientTrack tmpTk( *tmpRef, &(*bFieldHandle), globTkGeomHandle );
-      TransientTrack tmpTk( *tmpRef, magField );
-
-      double dzvtx = tmpRef->dz(bestvtx);
-      double dxyvtx = tmpRef->dxy(bestvtx);      
-      double dzerror = sqrt(tmpRef->dzError()*tmpRef->dzError()+zVtxError*zVtxError);
-      double dxyerror = sqrt(tmpRef->d0Error()*tmpRef->d0Error()+xVtxError*yVtxError);
-
-      double dauLongImpactSig = dzvtx/dzerror;
-      double dauTransImpactSig = dxyvtx/dxyerror;
-
-      if( fabs(dauTransImpactSig) > dauTransImpactSigCut && fabs(dauLongImpactSig) > dauLongImpactSigCut ) {
-        theTrackRefs.push_back( tmpRef );
-        theTransTracks.push_back( tmpTk );
-      }
-    }
+  std::vector<TrackRef> theSelectedTracks;
+  thePreselection.select(iEvent, theTrackHandle, bestvtx, math::XYZPoint(xVtxError,yVtxError,zVtxError), theSelectedTracks);
+  for(unsigned int indx = 0; indx < theSelectedTracks.size(); indx++) {
+    const TrackRef& tmpRef = theSelectedTracks[indx];
+    TransientTrack tmpTk( *tmpRef, magField );
+    theTrackRefs.push_back( tmpRef );
+    theTransTracks.push_back( tmpTk );
+  }
+
+  // Impact-point states are evaluated once per track and shared by all pairs
+  theTrackStates.clear();
+  theTrackStates.reserve(theTransTracks.size());
+  for(unsigned int indx = 0; indx < theTransTracks.size(); indx++) {
+    theTrackStates.push_back(theTransTracks[indx]);
   }
 
   float posCandMass[2] = {piMassD0, kaonMassD0};
@@ -242,58 +292,126 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   float negCandMass_sigma[2] = {kaonMassD0_sigma, piMassD0_sigma};
   int   pdg_id[2] = {421, -421};
 
+  // Transverse circles of the tracks, to drop the pairs failing tkDCACut
+  //  before ClosestApproachInRPhi
+  theTrackCircles.fill(theTrackStates);
+  std::vector<unsigned int> partnerSurvivors;
+  std::vector<PairSeed> pairSeeds;
+
+  const bool acceptRightSign = !isWrongSign || produceBothSigns;
+  const bool acceptWrongSign = isWrongSign || produceBothSigns;
+
   // Loop over tracks and vertex good charged track pairs
   for(unsigned int trdx1 = 0; trdx1 < theTrackRefs.size(); trdx1++) {
 
-    for(unsigned int trdx2 = trdx1 + 1; trdx2 < theTrackRefs.size(); trdx2++) {
+    if( !theTrackStates.isValid(trdx1) ) continue;
+
+    partnerSurvivors.clear();
+    theTrackCircles.select(theTrackCircles.circleAt(trdx1), trdx1 + 1, theTrackRefs.size(), tkDCACut, 0., partnerSurvivors);
+
+    // First pass: closest approach and momenta at the crossing point for
+    //  all partners, the mass windows are then tested on the whole block
+    pairSeeds.clear();
+    thePairMassFilter.clear();
+
+    for(unsigned int isurv = 0; isurv < partnerSurvivors.size(); isurv++) {
+
+      const unsigned int trdx2 = partnerSurvivors[isurv];
+
+      if( !theTrackStates.isValid(trdx2) ) continue;
 
       if( (theTrackRefs[trdx1]->pt() + theTrackRefs[trdx2]->pt()) < tkPtSumCut) continue;
       if( abs(theTrackRefs[trdx1]->eta() - theTrackRefs[trdx2]->eta()) > tkEtaDiffCut) continue;
 
-      //This vector holds the pair of oppositely-charged tracks to be vertexed
-      std::vector<TransientTrack> transTracks;
-
-      TrackRef positiveTrackRef;
-      TrackRef negativeTrackRef;
-      TransientTrack* posTransTkPtr = 0;
-      TransientTrack* negTransTkPtr = 0;
+      const int charge1 = theTrackStates.charge(trdx1);
+      const int charge2 = theTrackStates.charge(trdx2);
 
       // Look at the two tracks we're looping over.  If they're oppositely
       //  charged, load them into the hypothesized positive and negative tracks
       //  and references to be sent to the KalmanVertexFitter
-      if(!isWrongSign && theTrackRefs[trdx1]->charge() < 0. && 
-	 theTrackRefs[trdx2]->charge() > 0.) {
-	negativeTrackRef = theTrackRefs[trdx1];
-	positiveTrackRef = theTrackRefs[trdx2];
-	negTransTkPtr = &theTransTracks[trdx1];
-	posTransTkPtr = &theTransTracks[trdx2];
+      unsigned int posIndx = 0;
+      unsigned int negIndx = 0;
+      bool pairIsWrongSign = false;
+      if(acceptRightSign && charge1 < 0 && charge2 > 0) {
+        negIndx = trdx1;
+        posIndx = trdx2;
       }
-      else if(!isWrongSign && theTrackRefs[trdx1]->charge() > 0. &&
-	      theTrackRefs[trdx2]->charge() < 0.) {
-	negativeTrackRef = theTrackRefs[trdx2];
-	positiveTrackRef = theTrackRefs[trdx1];
-	negTransTkPtr = &theTransTracks[trdx2];
-	posTransTkPtr = &theTransTracks[trdx1];
+      else if(acceptRightSign && charge1 > 0 && charge2 < 0) {
+        negIndx = trdx2;
+        posIndx = trdx1;
       }
-      else if(isWrongSign && theTrackRefs[trdx1]->charge() > 0. &&
-              theTrackRefs[trdx2]->charge() > 0.) { 
-        negativeTrackRef = theTrackRefs[trdx2];
-        positiveTrackRef = theTrackRefs[trdx1];
-        negTransTkPtr = &theTransTracks[trdx2];
-        posTransTkPtr = &theTransTracks[trdx1];
+      else if(acceptWrongSign && charge1 > 0 && charge2 > 0) {
+        negIndx = trdx2;
+        posIndx = trdx1;
+        pairIsWrongSign = true;
       }
-      else if(isWrongSign && theTrackRefs[trdx1]->charge() < 0. &&
-              theTrackRefs[trdx2]->charge() < 0.) { 
-        negativeTrackRef = theTrackRefs[trdx1];
-        positiveTrackRef = theTrackRefs[trdx2];
-        negTransTkPtr = &theTransTracks[trdx1];
-        posTransTkPtr = &theTransTracks[trdx2];
+      else if(acceptWrongSign && charge1 < 0 && charge2 < 0) {
+        negIndx = trdx1;
+        posIndx = trdx2;
+        pairIsWrongSign = true;
       }
-
       // If they're not 2 oppositely charged tracks, loop back to the
       //  beginning and try the next pair.
       else continue;
 
+      // Trajectory states to calculate DCA for the 2 tracks
+      const FreeTrajectoryState& posState = theTrackStates.state(posIndx);
+      const FreeTrajectoryState& negState = theTrackStates.state(negIndx);
+
+      // Measure distance between tracks at their closest approach
+      ClosestApproachInRPhi cApp;
+      cApp.calculate(posState, negState);
+      if( !cApp.status() ) continue;
+      float dca = fabs( cApp.distance() );
+      GlobalPoint cxPt = cApp.crossingPoint();
+
+      if (dca < 0. || dca > tkDCACut) continue;
+//      if (sqrt( cxPt.x()*cxPt.x() + cxPt.y()*cxPt.y() ) > 120. 
+//          || std::abs(cxPt.z()) > 300.) continue;
+
+      // Get trajectory states for the tracks at POCA for later cuts
+      PairSeed seed;
+      seed.posIndx = posIndx;
+      seed.negIndx = negIndx;
+      seed.isWrongSign = pairIsWrongSign;
+      seed.posTSCP = theTransTracks[posIndx].trajectoryStateClosestToPoint( cxPt );
+      seed.negTSCP = theTransTracks[negIndx].trajectoryStateClosestToPoint( cxPt );
+
+      if( !seed.posTSCP.isValid() || !seed.negTSCP.isValid() ) continue;
+
+      const GlobalVector dauMomenta[2] = {seed.posTSCP.momentum(), seed.negTSCP.momentum()};
+      thePairMassFilter.push_back(dauMomenta);
+      pairSeeds.push_back(seed);
+    }
+
+    // K-pi and pi-K mass windows
+    const std::vector<char>& passMass = thePairMassFilter.select();
+
+    for(unsigned int iseed = 0; iseed < pairSeeds.size(); iseed++) {
+
+      if( !passMass[iseed] ) continue;
+
+      const unsigned int posIndx = pairSeeds[iseed].posIndx;
+      const unsigned int negIndx = pairSeeds[iseed].negIndx;
+      const bool pairIsWrongSign = pairSeeds[iseed].isWrongSign;
+      // with produceBothSigns the wrong-sign pairs are kept apart
+      const bool toWrongSign = produceBothSigns && pairIsWrongSign;
+      const TrajectoryStateClosestToPoint& posTSCP = pairSeeds[iseed].posTSCP;
+      const TrajectoryStateClosestToPoint& negTSCP = pairSeeds[iseed].negTSCP;
+
+      double totalPt =
+        ( posTSCP.momentum() + negTSCP.momentum() ).perp();
+
+      if( totalPt < dPtCut ) continue;
+
+      //This vector holds the pair of oppositely-charged tracks to be vertexed
+      std::vector<TransientTrack> transTracks;
+
+      TrackRef positiveTrackRef = theTrackRefs[posIndx];
+      TrackRef negativeTrackRef = theTrackRefs[negIndx];
+      TransientTrack* posTransTkPtr = &theTransTracks[posIndx];
+      TransientTrack* negTransTkPtr = &theTransTracks[negIndx];
+
       // Calculate DCA of two daughters
       double dzvtx_pos = positiveTrackRef->dz(bestvtx);
       double dxyvtx_pos = positiveTrackRef->dxy(bestvtx);
@@ -319,7 +437,7 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
       double dedx_neg=-999.;
       // Extract dEdx
       if(dEdxHandle.isValid()){
-        const edm::ValueMap<reco::DeDxData> dEdxTrack = *dEdxHandle.product();
+        const edm::ValueMap<reco::DeDxData>& dEdxTrack = *dEdxHandle.product();
         dedx_pos = dEdxTrack[positiveTrackRef].dEdx();
         dedx_neg = dEdxTrack[negativeTrackRef].dEdx();
       } 
@@ -330,74 +448,52 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
       transTracks.push_back(*posTransTkPtr);
       transTracks.push_back(*negTransTkPtr);
 
-      // Trajectory states to calculate DCA for the 2 tracks
-      FreeTrajectoryState posState = posTransTkPtr->impactPointTSCP().theState();
-      FreeTrajectoryState negState = negTransTkPtr->impactPointTSCP().theState();
-
-      if( !posTransTkPtr->impactPointTSCP().isValid() || !negTransTkPtr->impactPointTSCP().isValid() ) continue;
-
-      // Measure distance between tracks at their closest approach
-      ClosestApproachInRPhi cApp;
-      cApp.calculate(posState, negState);
-      if( !cApp.status() ) continue;
-      float dca = fabs( cApp.distance() );
-      GlobalPoint cxPt = cApp.crossingPoint();
-
-      if (dca < 0. || dca > tkDCACut) continue;
-//      if (sqrt( cxPt.x()*cxPt.x() + cxPt.y()*cxPt.y() ) > 120. 
-//          || std::abs(cxPt.z()) > 300.) continue;
-
-      // Get trajectory states for the tracks at POCA for later cuts
-      TrajectoryStateClosestToPoint posTSCP =
-        posTransTkPtr->trajectoryStateClosestToPoint( cxPt );
-      TrajectoryStateClosestToPoint negTSCP =
-        negTransTkPtr->trajectoryStateClosestToPoint( cxPt );
-
-      if( !posTSCP.isValid() || !negTSCP.isValid() ) continue;
-
-      double totalE1 = sqrt( posTSCP.momentum().mag2() + kaonMassD0Squared ) +
-                      sqrt( negTSCP.momentum().mag2() + piMassD0Squared );
-      double totalE1Sq = totalE1*totalE1;
-
-      double totalE2 = sqrt( posTSCP.momentum().mag2() + piMassD0Squared ) +
-                      sqrt( negTSCP.momentum().mag2() + kaonMassD0Squared );
-      double totalE2Sq = totalE2*totalE2;
-
-      double totalPSq =
-        ( posTSCP.momentum() + negTSCP.momentum() ).mag2();
-
-      double totalPt =
-        ( posTSCP.momentum() + negTSCP.momentum() ).perp();
-
-      double mass1 = sqrt( totalE1Sq - totalPSq);
-      double mass2 = sqrt( totalE2Sq - totalPSq);
-
-      if( (mass1 > mPiKCutMax || mass1 < mPiKCutMin) && (mass2 > mPiKCutMax || mass2 < mPiKCutMin)) continue;
-      if( totalPt < dPtCut ) continue;
-
       // Create the vertex fitter object and vertex the tracks
     
       float posCandTotalE[2]={0.0};
       float negCandTotalE[2]={0.0};
       float d0TotalE[2]={0.0};
 
+      // Vertex fit of the first hypothesis, reused by the second one in the
+      //  shared-fit mode. The daughter masses hardly move the vertex, so only
+      //  the energies are recomputed, unless the resulting pair mass is
+      //  within sharedFitEdgeMargin of a d0MassCut edge.
+      RefCountedKinematicTree sharedD0Vertex;
+      bool hasSharedD0Vertex = false;
+
       for(int i=0;i<2;i++)
       {
-        //Creating a KinematicParticleFactory
-        KinematicParticleFactoryFromTransientTrack pFactory;
-        
-        float chi = 0.0;
-        float ndf = 0.0;
+        RefCountedKinematicTree d0Vertex;
 
-        vector<RefCountedKinematicParticle> d0Particles;
-        d0Particles.push_back(pFactory.particle(*posTransTkPtr,posCandMass[i],chi,ndf,posCandMass_sigma[i]));
-        d0Particles.push_back(pFactory.particle(*negTransTkPtr,negCandMass[i],chi,ndf,negCandMass_sigma[i]));
+        double sharedMass = -1.;
+        if( hasSharedD0Vertex ) sharedMass = refitPairMass(sharedD0Vertex, posCandMass[i], negCandMass[i]);
 
-        KinematicParticleVertexFitter d0Fitter;
-        RefCountedKinematicTree d0Vertex;
-        d0Vertex = d0Fitter.fit(d0Particles);
+        if( hasSharedD0Vertex &&
+            fabs(sharedMass - (d0MassD0 - d0MassCut)) >= sharedFitEdgeMargin &&
+            fabs(sharedMass - (d0MassD0 + d0MassCut)) >= sharedFitEdgeMargin ) {
+          d0Vertex = sharedD0Vertex;
+        }
+        else {
+          //Creating a KinematicParticleFactory
+          KinematicParticleFactoryFromTransientTrack pFactory;
+
+          float chi = 0.0;
+          float ndf = 0.0;
+
+          vector<RefCountedKinematicParticle> d0Particles;
+          d0Particles.push_back(pFactory.particle(*posTransTkPtr,posCandMass[i],chi,ndf,posCandMass_sigma[i]));
+          d0Particles.push_back(pFactory.particle(*negTransTkPtr,negCandMass[i],chi,ndf,negCandMass_sigma[i]));
+
+          KinematicParticleVertexFitter d0Fitter;
+          d0Vertex = d0Fitter.fit(d0Particles);
 
-        if( !d0Vertex->isValid() ) continue;
+          if( !d0Vertex->isValid() ) continue;
+
+          if( sharedVertexFit && i == 0 ) {
+            sharedD0Vertex = d0Vertex;
+            hasSharedD0Vertex = true;
+          }
+        }
 
         d0Vertex->movePointerToTheTop();
         RefCountedKinematicParticle d0Cand = d0Vertex->currentParticle();
@@ -505,7 +601,7 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
                                                    negCandTotalE[i]), d0Vtx);
         theNegCand.setTrack(negativeTrackRef);
 
-        if(isWrongSign)
+        if(pairIsWrongSign)
         {
           thePosCand.setCharge(theTrackRefs[trdx1]->charge());
           theNegCand.setCharge(theTrackRefs[trdx1]->charge());
@@ -520,7 +616,8 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
             theD0->mass() > d0MassD0 - d0MassCut ) //&&
 	   // theD0->pt() > dPtCut ) {
         {
-          theD0s.push_back( *theD0 );
+          if(toWrongSign) theD0sWS.push_back( *theD0 );
+          else theD0s.push_back( *theD0 );
 
 // perform MVA evaluation
           if(useAnyMVA_)
@@ -547,15 +644,14 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
             gbrVals_[18] = posCandTotalP.eta();
             gbrVals_[19] = negCandTotalP.eta();
 
-            GBRForest const * forest = forest_;
-            if(useForestFromDB_){
-              edm::ESHandle<GBRForest> forestHandle;
-              iSetup.get<GBRWrapperRcd>().get(forestLabel_,forestHandle);
-              forest = forestHandle.product();
+            if(compiledForest_.isValid()) {
+              if(toWrongSign) mvaValsWS_.push_back(compiledForest_.GetClassifier(gbrVals_));
+              else mvaVals_.push_back(compiledForest_.GetClassifier(gbrVals_));
+            }
+            else {
+              mvaFeatures_.push_back(gbrVals_);
+              mvaWrongSign_.push_back(toWrongSign);
             }
-
-            auto gbrVal = forest->GetClassifier(gbrVals_);
-            mvaVals_.push_back(gbrVal);
           }
         }
 
@@ -564,6 +660,18 @@ void D0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
     }
   }
 
+  // evaluate the MVA of all D0 candidates of the event in one pass
+  if(useAnyMVA_ && !compiledForest_.isValid())
+  {
+    flatForest_.GetClassifier(mvaFeatures_, mvaBatch_);
+    for(unsigned int k = 0; k < mvaBatch_.size(); k++) {
+      if(mvaWrongSign_[k]) mvaValsWS_.push_back(mvaBatch_[k]);
+      else mvaVals_.push_back(mvaBatch_[k]);
+    }
+    mvaFeatures_.clear();
+    mvaWrongSign_.clear();
+  }
+
 //  mvaFiller.insert(theD0s,mvaVals_.begin(),mvaVals_.end());
 //  mvaFiller.fill();
 //  mvas = std::make_unique<MVACollection>(mvaVals_.begin(),mvaVals_.end());
@@ -579,13 +687,45 @@ const std::vector<float>& D0Fitter::getMVAVals() const {
   return mvaVals_;
 }
 
+std::unique_ptr<reco::VertexCompositeCandidateCollection> D0Fitter::releaseD0() {
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+  theReleased->swap(theD0s);
+  return theReleased;
+}
+
+std::unique_ptr<std::vector<float> > D0Fitter::releaseMVAVals() {
+  std::unique_ptr<std::vector<float> > theReleased(new std::vector<float>);
+  theReleased->swap(mvaVals_);
+  return theReleased;
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> D0Fitter::releaseD0WS() {
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+  theReleased->swap(theD0sWS);
+  return theReleased;
+}
+
+std::unique_ptr<std::vector<float> > D0Fitter::releaseMVAValsWS() {
+  std::unique_ptr<std::vector<float> > theReleased(new std::vector<float>);
+  theReleased->swap(mvaValsWS_);
+  return theReleased;
+}
+
 /*
 auto_ptr<edm::ValueMap<float> > D0Fitter::getMVAMap() const {
   return mvaValValueMap;
 }
 */
 
+unsigned int D0Fitter::forestLookups() const {
+  return forestLookups_;
+}
+
 void D0Fitter::resetAll() {
     theD0s.clear();
+    theD0sWS.clear();
     mvaVals_.clear();
+    mvaValsWS_.clear();
+    mvaFeatures_.clear();
+    mvaWrongSign_.clear();
 }
@@ -21,6 +21,7 @@
 #include <memory>
 
 #include "VertexCompositeAnalysis/VertexCompositeProducer/interface/D0Producer.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 
 // Constructor
 D0Producer::D0Producer(const edm::ParameterSet& iConfig) :
@@ -29,8 +30,15 @@ D0Producer::D0Producer(const edm::ParameterSet& iConfig) :
   useAnyMVA_ = false;
   if(iConfig.exists("useAnyMVA")) useAnyMVA_ = iConfig.getParameter<bool>("useAnyMVA");
  
+  produceBothSigns_ = false;
+  if(iConfig.exists("produceBothSigns")) produceBothSigns_ = iConfig.getParameter<bool>("produceBothSigns");
   produces< reco::VertexCompositeCandidateCollection >("D0");
   if(useAnyMVA_) produces<MVACollection>("MVAValuesD0");
+  if(produceBothSigns_)
+  {
+    produces< reco::VertexCompositeCandidateCollection >("D0WS");
+    if(useAnyMVA_) produces<MVACollection>("MVAValuesD0WS");
+  }
 }
 
 // (Empty) Destructor
@@ -55,21 +63,26 @@ void D0Producer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
 //   std::auto_ptr< reco::VertexCompositeCandidateCollection >
 //     d0Candidates( new reco::VertexCompositeCandidateCollection );
 //
-   auto d0Candidates = std::make_unique<reco::VertexCompositeCandidateCollection>();
-   d0Candidates->reserve( theVees.getD0().size() );
-
-   std::copy( theVees.getD0().begin(),
-              theVees.getD0().end(),
-              std::back_inserter(*d0Candidates) );
+   auto d0Candidates = theVees.releaseD0();
 
    // Write the collections to the Event
    iEvent.put( std::move(d0Candidates), std::string("D0") );
     
    if(useAnyMVA_) 
    {
-     auto mvas = std::make_unique<MVACollection>(theVees.getMVAVals().begin(),theVees.getMVAVals().end());
+     auto mvas = theVees.releaseMVAVals();
      iEvent.put(std::move(mvas), std::string("MVAValuesD0"));
    }
+   if(produceBothSigns_)
+   {
+     auto d0WSCandidates = theVees.releaseD0WS();
+     iEvent.put( std::move(d0WSCandidates), std::string("D0WS") );
+     if(useAnyMVA_)
+     {
+       auto mvasWS = theVees.releaseMVAValsWS();
+       iEvent.put(std::move(mvasWS), std::string("MVAValuesD0WS"));
+     }
+   }
 
    theVees.resetAll();
 }
@@ -81,6 +94,8 @@ void D0Producer::beginJob() {
 
 
 void D0Producer::endJob() {
+  if(useAnyMVA_)
+    edm::LogInfo("D0Producer") << "GBRForest looked up " << theVees.forestLookups() << " times in the EventSetup";
 }
 
 //define this as a plug-in
@@ -82,6 +82,10 @@ DiMuFitter::DiMuFitter(const edm::ParameterSet& theParameters,  edm::ConsumesCol
   isGlobalMuon = theParameters.getParameter<bool>(string("isGlobalMuon"));
   isWrongSign = theParameters.getParameter<bool>(string("isWrongSign"));
 
+  // parse the muon ID once, not for every muon
+  muonSelectionType = muon::All;
+  if(isMuonId) muonSelectionType = muon::selectionTypeFromString(muonId);
+
   std::vector<std::string> qual = theParameters.getParameter<std::vector<std::string> >("trackQualities");
   for (unsigned int ndx = 0; ndx < qual.size(); ndx++) {
     qualities.push_back(reco::TrackBase::qualityByName(qual[ndx]));
@@ -138,7 +142,7 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
   double xVtxError=-999.0;
   double yVtxError=-999.0;
   double zVtxError=-999.0;
-  const reco::VertexCollection vtxCollection = *(theVertexHandle.product());
+  const reco::VertexCollection& vtxCollection = *(theVertexHandle.product());
   reco::VertexCollection::const_iterator vtxPrimary = vtxCollection.begin();
   if(vtxCollection.size()>0 && !vtxPrimary->isFake() && vtxPrimary->tracksSize()>=2)
   {
@@ -161,31 +165,36 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
   }
   math::XYZPoint bestvtx(xVtx,yVtx,zVtx);
 
+   // Muon preselection, evaluated once per muon. The accepted muons are
+   //  split by charge and keep the order of the muon collection.
+   thePosMuons.clear();
+   theNegMuons.clear();
+
    for( unsigned ic = 0; ic < theMuonHandle->size(); ic++ ) {
 
-     const reco::Muon& cand1 = (*theMuonHandle)[ic];
-     if(isMuonId && !muon::isGoodMuon(cand1, muon::selectionTypeFromString(muonId))) continue;  //DataFormats/MuonReco/interface/MuonSelectors.h, TMOneStationTight = 12
-     if(isPFMuon && !cand1.isPFMuon()) continue; 
-     if(isGlobalMuon && !cand1.isGlobalMuon()) continue;
+     const reco::Muon& cand = (*theMuonHandle)[ic];
+     if(isMuonId && !muon::isGoodMuon(cand, muonSelectionType)) continue;  //DataFormats/MuonReco/interface/MuonSelectors.h, TMOneStationTight = 12
+     if(isPFMuon && !cand.isPFMuon()) continue; 
+     if(isGlobalMuon && !cand.isGlobalMuon()) continue;
 
 //   recoMu.numberOfMatchedStations() > 1
 /*
-     const reco::PFCandidate& cand1 = (*thePfCandHandle)[ic];
-     int type1 = cand1.particleId();
-     if(isEE && type1 != reco::PFCandidate::e) continue;
-     if(isMuMu && type1 != reco::PFCandidate::mu) continue;
+     const reco::PFCandidate& cand = (*thePfCandHandle)[ic];
+     int type = cand.particleId();
+     if(isEE && type != reco::PFCandidate::e) continue;
+     if(isMuMu && type != reco::PFCandidate::mu) continue;
 
-     reco::TrackRef trackRef1 = cand1.trackRef();
+     reco::TrackRef trackRef = cand.trackRef();
 */
 
-     reco::TrackRef trackRef1 = cand1.track();
-     if(trackRef1.isNull()) continue;
+     reco::TrackRef trackRef = cand.track();
+     if(trackRef.isNull()) continue;
 
      bool quality_ok = true;
      if (qualities.size()!=0) {
        quality_ok = false;
        for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
-         if (trackRef1->quality(qualities[ndx_])){
+         if (trackRef->quality(qualities[ndx_])){
            quality_ok = true;
            break;
          }
@@ -193,37 +202,58 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
      }
      if( !quality_ok ) continue;
 
-     TransientTrack tmpTk1( *trackRef1, magField );
-     if( trackRef1->normalizedChi2() < tkChi2Cut &&
-         trackRef1->numberOfValidHits() >= tkNhitsCut &&
-         trackRef1->hitPattern().pixelLayersWithMeasurement() > 0 &&
-         trackRef1->pt() > tkPtCut && fabs(trackRef1->eta()) < tkEtaCut) {
+     double dzvtx = trackRef->dz(bestvtx);
+     double dxyvtx = trackRef->dxy(bestvtx);
+     double dzerror = sqrt(trackRef->dzError()*trackRef->dzError()+zVtxError*zVtxError);
+     double dxyerror = sqrt(trackRef->d0Error()*trackRef->d0Error()+xVtxError*yVtxError);
 
-       double dzvtx = trackRef1->dz(bestvtx);
-       double dxyvtx = trackRef1->dxy(bestvtx);
-       double dzerror = sqrt(trackRef1->dzError()*trackRef1->dzError()+zVtxError*zVtxError);
-       double dxyerror = sqrt(trackRef1->d0Error()*trackRef1->d0Error()+xVtxError*yVtxError);
+     double dauLongImpactSig = dzvtx/dzerror;
+     double dauTransImpactSig = dxyvtx/dxyerror;
 
-       double dauLongImpactSig = dzvtx/dzerror;
-       double dauTransImpactSig = dxyvtx/dxyerror;
+     // the impact parameter cuts only apply to the tracks passing the track cuts
+     if( trackRef->normalizedChi2() < tkChi2Cut &&
+         trackRef->numberOfValidHits() >= tkNhitsCut &&
+         trackRef->hitPattern().pixelLayersWithMeasurement() > 0 &&
+         trackRef->pt() > tkPtCut && fabs(trackRef->eta()) < tkEtaCut) {
 
        if( fabs(dzvtx)>20. || fabs(dxyvtx)>0.3 ) continue;
        if( fabs(dauTransImpactSig) < dauTransImpactSigCut || fabs(dauLongImpactSig) < dauLongImpactSigCut ) continue;
      }
 
-     for( unsigned fc = ic+1; fc < theMuonHandle->size(); fc++ ) {
+     PreselectedMuon theMuon;
+     theMuon.indx = ic;
+     theMuon.trackRef = trackRef;
+     theMuon.transTrack = TransientTrack( *trackRef, magField );
+     theMuon.dauTransImpactSig = dauTransImpactSig;
+     theMuon.dauLongImpactSig = dauLongImpactSig;
 
-       const reco::Muon& cand2 = (*theMuonHandle)[fc];
-       if(isMuonId && !muon::isGoodMuon(cand2, muon::selectionTypeFromString(muonId))) continue;  
-       if(isPFMuon && !cand2.isPFMuon()) continue;
-       if(isGlobalMuon && !cand2.isGlobalMuon()) continue;
+     if(trackRef->charge() > 0.) thePosMuons.push_back( theMuon );
+     else if(trackRef->charge() < 0.) theNegMuons.push_back( theMuon );
+   }
+
+   // Pairs of preselected muons, in the order of the muon collection. The
+   //  two charge lists are merged for the first muon, the partners are the
+   //  later muons of the other list (of the same list for wrong sign).
+   unsigned int ipos = 0;
+   unsigned int ineg = 0;
+   while( ipos < thePosMuons.size() || ineg < theNegMuons.size() ) {
+
+     const bool firstIsPos = ineg == theNegMuons.size() ||
+                             (ipos < thePosMuons.size() && thePosMuons[ipos].indx < theNegMuons[ineg].indx);
+     const PreselectedMuon& muon1 = firstIsPos ? thePosMuons[ipos++] : theNegMuons[ineg++];
+
+     const bool partnerIsPos = (firstIsPos == isWrongSign);
+     const std::vector<PreselectedMuon>& partners = partnerIsPos ? thePosMuons : theNegMuons;
+     const unsigned int firstPartner = partnerIsPos ? ipos : ineg;
+
+     const reco::Muon& cand1 = (*theMuonHandle)[muon1.indx];
+     const reco::TrackRef& trackRef1 = muon1.trackRef;
+
+     for( unsigned fc = firstPartner; fc < partners.size(); fc++ ) {
+
+       const PreselectedMuon& muon2 = partners[fc];
+       const reco::Muon& cand2 = (*theMuonHandle)[muon2.indx];
 
-/*
-       const reco::PFCandidate& cand2 = (*thePfCandHandle)[fc];
-       int type2 = cand2.particleId();
-       if(isEE && type2 != reco::PFCandidate::e) continue;
-       if(isMuMu && type2 != reco::PFCandidate::mu) continue;
-*/
        double totalE = sqrt( cand1.p() + dauMassSquared ) +
                        sqrt( cand2.p() + dauMassSquared );
        double totalESq = totalE*totalE;
@@ -235,37 +265,7 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
 
        if( (mass > mllCutMax || mass < mllCutMin) && (mass > mllCutMax || mass < mllCutMin)) continue;
 
-       reco::TrackRef trackRef2 = cand2.track();
-       if(trackRef2.isNull()) continue;
-       
-       if (qualities.size()!=0) {
-         quality_ok = false;
-         for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
-           if (trackRef2->quality(qualities[ndx_])){
-             quality_ok = true;
-             break;
-           }
-         }
-       }
-       if( !quality_ok ) continue;
-
-       TransientTrack tmpTk2( *trackRef2, magField );
-       if( trackRef2->normalizedChi2() < tkChi2Cut &&
-           trackRef2->numberOfValidHits() >= tkNhitsCut &&
-           trackRef2->hitPattern().pixelLayersWithMeasurement() > 0 &&
-           trackRef2->pt() > tkPtCut && fabs(trackRef2->eta()) < tkEtaCut) {
-
-         double dzvtx = trackRef2->dz(bestvtx);
-         double dxyvtx = trackRef2->dxy(bestvtx);
-         double dzerror = sqrt(trackRef2->dzError()*trackRef2->dzError()+zVtxError*zVtxError);
-         double dxyerror = sqrt(trackRef2->d0Error()*trackRef2->d0Error()+xVtxError*yVtxError);
-
-         double dauLongImpactSig = dzvtx/dzerror;
-         double dauTransImpactSig = dxyvtx/dxyerror;
-
-         if( fabs(dzvtx)>20. || fabs(dxyvtx)>0.3 ) continue;
-         if( fabs(dauTransImpactSig) < dauTransImpactSigCut || fabs(dauLongImpactSig) < dauLongImpactSigCut ) continue;
-       }
+       const reco::TrackRef& trackRef2 = muon2.trackRef;
 
 //       reco::PFCandidate posCand;
 //       reco::PFCandidate negCand;
@@ -273,8 +273,8 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
        reco::Muon negCand;
        TrackRef positiveTrackRef;
        TrackRef negativeTrackRef;
-       TransientTrack* posTransTkPtr = 0;
-       TransientTrack* negTransTkPtr = 0;
+       const TransientTrack* posTransTkPtr = 0;
+       const TransientTrack* negTransTkPtr = 0;
 
        if(!isWrongSign && trackRef1->charge() < 0. &&
           trackRef2->charge() > 0.) {
@@ -282,8 +282,8 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
          negCand = cand1;
          negativeTrackRef = trackRef1;
          positiveTrackRef = trackRef2;
-         negTransTkPtr = &tmpTk1;
-         posTransTkPtr = &tmpTk2;
+         negTransTkPtr = &muon1.transTrack;
+         posTransTkPtr = &muon2.transTrack;
        }
        else if(!isWrongSign && trackRef1->charge() > 0. &&
                trackRef2->charge() < 0.) {
@@ -291,16 +291,16 @@ void DiMuFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup)
          negCand = cand2;
          negativeTrackRef = trackRef2;
          positiveTrackRef = trackRef1;
-         negTransTkPtr = &tmpTk2;
-         posTransTkPtr = &tmpTk1;
+         negTransTkPtr = &muon2.transTrack;
+         posTransTkPtr = &muon1.transTrack;
        }
        else if(isWrongSign &&  trackRef1->charge()* trackRef2->charge() > 0.0) {
          posCand = cand1;
          negCand = cand2;
          negativeTrackRef = trackRef2;
          positiveTrackRef = trackRef1;
-         negTransTkPtr = &tmpTk2;
-         posTransTkPtr = &tmpTk1;
+         negTransTkPtr = &muon2.transTrack;
+         posTransTkPtr = &muon1.transTrack;
        }
        else continue;
 
@@ -468,6 +468,12 @@ const reco::VertexCompositeCandidateCollection& DiMuFitter::getDiMu() const {
   return theDiMus;
 }
 
+std::unique_ptr<reco::VertexCompositeCandidateCollection> DiMuFitter::releaseDiMu() {
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+  theReleased->swap(theDiMus);
+  return theReleased;
+}
+
 void DiMuFitter::resetAll() {
     theDiMus.clear();
 }
@@ -50,13 +50,7 @@ void DiMuProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
    // Create auto_ptr for each collection to be stored in the Event
 //   std::auto_ptr< reco::VertexCompositeCandidateCollection >
 //     dimuCandidates( new reco::VertexCompositeCandidateCollection );
-   auto dimuCandidates = std::make_unique<reco::VertexCompositeCandidateCollection>();
-
-   dimuCandidates->reserve( theVees.getDiMu().size() );
-
-   std::copy( theVees.getDiMu().begin(),
-              theVees.getDiMu().end(),
-              std::back_inserter(*dimuCandidates) );
+   auto dimuCandidates = theVees.releaseDiMu();
 
    // Write the collections to the Event
    iEvent.put( std::move(dimuCandidates), std::string("DiMu") ); 
@@ -37,10 +37,111 @@
 #include <Math/SMatrix.h>
 #include <TMath.h>
 #include <TVector3.h>
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+
 #include "TrackingTools/IPTools/interface/IPTools.h"
 #include "CommonTools/Statistics/interface/ChiSquaredProbability.h"
 #include "CondFormats/DataRecord/interface/GBRWrapperRcd.h"
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
+namespace {
+  // Second track that passed the DCA cut with the first one, with both
+  //  states at their crossing point
+  struct LamC3PSeed {
+    unsigned int indx;
+    TrajectoryStateClosestToPoint trkTSCP1;
+    TrajectoryStateClosestToPoint trkTSCP2;
+  };
+
+  // Third track that passed the DCA cut with the first one, with its
+  //  state at their crossing point
+  struct TripletSeed {
+    unsigned int indx;
+    TrajectoryStateClosestToPoint trkTSCP31;
+  };
+
+  // Closest approaches of one first track with the tracks of a list,
+  //  keyed by the index of the partner track in that list. The entries
+  //  are evaluated on first use, so a third track is approached once per
+  //  first track instead of once per pair.
+  class ApproachMemo {
+   public:
+    struct Approach {
+      bool pass;                                // status and DCA cut
+      GlobalPoint cxPt;
+      TrajectoryStateClosestToPoint trkTSCP;    // partner track at cxPt
+    };
+
+    void reset(unsigned int nTracks) {
+      theSlots.assign(nTracks, -1);
+      theApproaches.clear();
+    }
+
+    // null if the pair has not been evaluated yet
+    const Approach* find(unsigned int indx) const {
+      return theSlots[indx] < 0 ? nullptr : &theApproaches[theSlots[indx]];
+    }
+
+    // the reference is valid until the next insert
+    Approach& insert(unsigned int indx) {
+      theSlots[indx] = theApproaches.size();
+      theApproaches.push_back(Approach());
+      return theApproaches.back();
+    }
+
+   private:
+    std::vector<int> theSlots;
+    std::vector<Approach> theApproaches;
+  };
+
+  // Slack on the third-track momentum range. The mass windows are tested
+  //  with float momenta at the crossing points, so it must never be tight.
+  const double thirdMomentumTolerance = 1.e-3;
+  const double thirdMassTolerance = 1.e-4;
+
+  // Momentum magnitudes of a third track of mass m3 for which the
+  //  three-body mass can fall in [mMin, mMax], given the pair momenta p1
+  //  and p2 with masses m1 and m2. With the pair written as (M, Y) and the
+  //  third track as (m3, y) in rapidity along their own directions, the
+  //  three-body mass squared is M^2 + m3^2 + 2*M*m3*cosh(y-Y) for parallel
+  //  momenta and M^2 + m3^2 + 2*M*m3*cosh(y+Y) for opposite ones, so the
+  //  admissible y form one interval. Empty if first > second.
+  std::pair<double, double> thirdMomentumRange(const GlobalVector& p1, double m1,
+                                               const GlobalVector& p2, double m2,
+                                               double m3, double mMin, double mMax) {
+    const std::pair<double, double> empty(std::numeric_limits<double>::max(), 0.);
+
+    const double e12 = sqrt(p1.mag2() + m1*m1) + sqrt(p2.mag2() + m2*m2);
+    const double p12 = (p1 + p2).mag();
+    const double m12 = sqrt(e12*e12 - p12*p12);
+    const double y12 = asinh(p12/m12);
+    const double scale = 2.*m12*m3;
+
+    const double mHigh = mMax + thirdMassTolerance;
+    const double maxCosh = (mHigh*mHigh - m12*m12 - m3*m3)/scale;
+    if( !(maxCosh >= 1.) ) return empty;
+    const double rapDiff = acosh(maxCosh);
+
+    double yLow = y12 - rapDiff;
+    const double yHigh = y12 + rapDiff;
+    const double mLow = mMin - thirdMassTolerance;
+    if( mLow > 0. ) {
+      const double minCosh = (mLow*mLow - m12*m12 - m3*m3)/scale;
+      if( minCosh > 1. ) yLow = std::max(yLow, acosh(minCosh) - y12);
+    }
+    if( yHigh < yLow ) return empty;
+
+    const double pLow = yLow > 0. ? m3*sinh(yLow) : 0.;
+    const double pHigh = m3*sinh(yHigh);
+    return std::make_pair(pLow*(1. - thirdMomentumTolerance), pHigh*(1. + thirdMomentumTolerance));
+  }
+}
+
 const float piMassLamC3P = 0.13957018;
 const float piMassLamC3PSquared = piMassLamC3P*piMassLamC3P;
 const float kaonMassLamC3P = 0.493677;
@@ -98,6 +199,13 @@ LamC3PFitter::LamC3PFitter(const edm::ParameterSet& theParameters,  edm::Consume
   alpha2DCut = theParameters.getParameter<double>(string("alpha2DCut"));
   isWrongSign = theParameters.getParameter<bool>(string("isWrongSign"));
 
+  //  -whether to run the loop over the first track as parallel tasks, and
+  //   the number of first tracks per task
+  parallelPairLoop = false;
+  if(theParameters.exists("parallelPairLoop")) parallelPairLoop = theParameters.getParameter<bool>("parallelPairLoop");
+  pairLoopGrainSize = 1;
+  if(theParameters.exists("pairLoopGrainSize")) pairLoopGrainSize = std::max(1, theParameters.getParameter<int>("pairLoopGrainSize"));
+
 
   useAnyMVA_ = false;
   forestLabel_ = "LamC3PInpPb";
@@ -131,6 +239,31 @@ LamC3PFitter::LamC3PFitter(const edm::ParameterSet& theParameters,  edm::Consume
   for (unsigned int ndx = 0; ndx < qual.size(); ndx++) {
     qualities.push_back(reco::TrackBase::qualityByName(qual[ndx]));
   }
+
+  TrackPreselection::Cuts trackCuts;
+  trackCuts.qualities = qualities;
+  trackCuts.chi2Cut = tkChi2Cut;
+  trackCuts.nhitsCut = tkNhitsCut;
+  trackCuts.ptCut = tkPtCut;
+  trackCuts.ptErrCut = tkPtErrCut;
+  trackCuts.etaCut = tkEtaCut;
+  trackCuts.transImpactSigCut = dauTransImpactSigCut;
+  trackCuts.longImpactSigCut = dauLongImpactSigCut;
+  thePreselection.setup(theParameters, iC, trackCuts);
+
+  // proton-pion assignment of the two same-sign tracks, either one has to
+  //  fall in the window
+  const float pPiMassesSquared[2] = {protonMassLamC3PSquared, piMassLamC3PSquared};
+  const float piPMassesSquared[2] = {piMassLamC3PSquared, protonMassLamC3PSquared};
+  thePairMassFilter.setRequireAll(false);
+  thePairMassFilter.addHypothesis(pPiMassesSquared, mKPCutMin, mKPCutMax);
+  thePairMassFilter.addHypothesis(piPMassesSquared, mKPCutMin, mKPCutMax);
+
+  const float pPiKMassesSquared[3] = {protonMassLamC3PSquared, piMassLamC3PSquared, kaonMassLamC3PSquared};
+  const float piPKMassesSquared[3] = {piMassLamC3PSquared, protonMassLamC3PSquared, kaonMassLamC3PSquared};
+  theTripletMassFilter.setRequireAll(false);
+  theTripletMassFilter.addHypothesis(pPiKMassesSquared, mPiKPCutMin, mPiKPCutMax);
+  theTripletMassFilter.addHypothesis(piPKMassesSquared, mPiKPCutMin, mPiKPCutMax);
 }
 
 LamC3PFitter::~LamC3PFitter() {
@@ -147,12 +280,10 @@ void LamC3PFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetu
   using namespace edm;
   using namespace std; 
 
-  // Create std::vectors for Tracks and TrackRefs (required for
-  //  passing to the KalmanVertexFitter)
-  std::vector<TrackRef> theTrackRefs_pos;
-  std::vector<TrackRef> theTrackRefs_neg;
-  std::vector<TransientTrack> theTransTracks_pos;
-  std::vector<TransientTrack> theTransTracks_neg;
+  // Preselected TrackRefs and TransientTracks (required for
+  //  passing to the KalmanVertexFitter), kept across events
+  thePosTracks.clear();
+  theNegTracks.clear();
 
   // Handles for tracks, B-field, and tracker geometry
   Handle<reco::TrackCollection> theTrackHandle;
@@ -184,7 +315,7 @@ void LamC3PFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetu
   double xVtxError=-999.0;
   double yVtxError=-999.0;
   double zVtxError=-999.0;
-  const reco::VertexCollection vtxCollection = *(theVertexHandle.product());
+  const reco::VertexCollection& vtxCollection = *(theVertexHandle.product());
   reco::VertexCollection::const_iterator vtxPrimary = vtxCollection.begin();
   if(vtxCollection.size()>0 && !vtxPrimary->isFake() && vtxPrimary->tracksSize()>=2)
   {
@@ -209,67 +340,41 @@ void LamC3PFitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetu
   math::XYZPoint bestvtxError(xVtxError,yVtxError,zVtxError);
 
   // Fill vectors of TransientTracks and TrackRefs after applying preselection cuts.
-  for(unsigned int indx = 0; indx < theTrackHandle->size(); indx++) {
-    TrackRef tmpRef( theTrackHandle, indx );
-    bool quality_ok = true;
-    if (qualities.size()!=0) {
-      quality_ok = false;
-      for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
-	if (tmpRef->quality(qualities[ndx_])){
-	  quality_ok = true;
-	  break;          
-	}
-      }
+  std::vector<TrackRef> theSelectedTracks;
+  thePreselection.select(iEvent, theTrackHandle, bestvtx, bestvtxError, theSelectedTracks);
+  for(unsigned int indx = 0; indx < theSelectedTracks.size(); indx++) {
+    const TrackRef& tmpRef = theSelectedTracks[indx];
+    TransientTrack tmpTk( *tmpRef, magField );
+    if(tmpRef->charge()>0.0)
+    {
+      thePosTracks.push_back( tmpRef, tmpTk );
     }
-    if( !quality_ok ) continue;
-
-    if( tmpRef->normalizedChi2() < tkChi2Cut &&
-        tmpRef->numberOfValidHits() >= tkNhitsCut &&
-        tmpRef->ptError() / tmpRef->pt() < tkPtErrCut &&
-        tmpRef->pt() > tkPtCut && fabs(tmpRef->eta()) < tkEtaCut ) {
-//      TransientTrack tmpTk( *tmpRef, &(*bFieldHandle), globTkGeomHandle );
-      TransientTrack tmpTk( *tmpRef, magField );
-
-      double dzvtx = tmpRef->dz(bestvtx);
-      double dxyvtx = tmpRef->dxy(bestvtx);      
-      double dzerror = sqrt(tmpRef->dzError()*tmpRef->dzError()+zVtxError*zVtxError);
-      double dxyerror = sqrt(tmpRef->d0Error()*tmpRef->d0Error()+xVtxError*yVtxError);
-
-      double dauLongImpactSig = dzvtx/dzerror;
-      double dauTransImpactSig = dxyvtx/dxyerror;
-
-      if( fabs(dauTransImpactSig) > dauTransImpactSigCut && fabs(dauLongImpactSig) > dauLongImpactSigCut ) {
-        if(tmpRef->charge()>0.0)
-        {
-          theTrackRefs_pos.push_back( tmpRef );
-          theTransTracks_pos.push_back( tmpTk );
-        }
-        if(tmpRef->charge()<0.0)
-        {
-          theTrackRefs_neg.push_back( tmpRef );
-          theTransTracks_neg.push_back( tmpTk );
-        }
-      }
+    if(tmpRef->charge()<0.0)
+    {
+      theNegTracks.push_back( tmpRef, tmpTk );
     }
   }
 
+  // Impact-point states and transverse circles of both lists, to drop the
+  //  pairs failing tkDCACut before ClosestApproachInRPhi
+  thePosTracks.fillStates();
+  theNegTracks.fillStates();
+
   if(!isWrongSign)
   {
-    fitLamCCandidates(theTrackRefs_pos,theTrackRefs_neg,theTransTracks_pos,theTransTracks_neg,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,4122);
-    fitLamCCandidates(theTrackRefs_neg,theTrackRefs_pos,theTransTracks_neg,theTransTracks_pos,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,-4122);
+    fitLamCCandidates(thePosTracks,theNegTracks,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,4122);
+    fitLamCCandidates(theNegTracks,thePosTracks,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,-4122);
   }
   else 
   {
-    fitLamCCandidates(theTrackRefs_pos,theTrackRefs_pos,theTransTracks_pos,theTransTracks_pos,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,4122);
-    fitLamCCandidates(theTrackRefs_neg,theTrackRefs_neg,theTransTracks_neg,theTransTracks_neg,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,-4122);    
+    fitLamCCandidates(thePosTracks,thePosTracks,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,4122);
+    fitLamCCandidates(theNegTracks,theNegTracks,isVtxPV,vtxPrimary,theBeamSpotHandle,bestvtx,bestvtxError,-4122);    
   }
 }
 
 void LamC3PFitter::fitLamCCandidates(
-                                  std::vector<reco::TrackRef> theTrackRefs_sgn1,
-                                  std::vector<reco::TrackRef> theTrackRefs_sgn2,
-                                  std::vector<reco::TransientTrack> theTransTracks_sgn1,
-                                  std::vector<reco::TransientTrack> theTransTracks_sgn2,
+                                  const PreselectedTrackStore& theTracks_sgn1,
+                                  const PreselectedTrackStore& theTracks_sgn2,
                                   bool isVtxPV,
                                   reco::VertexCollection::const_iterator vtxPrimary, edm::Handle<reco::BeamSpot> theBeamSpotHandle,
                                   math::XYZPoint bestvtx, math::XYZPoint bestvtxError,
@@ -288,20 +393,121 @@ void LamC3PFitter::fitLamCCandidates(
 
   int lamCCharge = pdg_id/abs(pdg_id);
 
-  // Loop over tracks and vertex good charged track pairs
-  for(unsigned int trdx1 = 0; trdx1 < theTrackRefs_sgn1.size(); trdx1++) {
+  const TrackStateTable& theTrackStates1 = theTracks_sgn1.states();
+  const TrackStateTable& theTrackStates2 = theTracks_sgn2.states();
+  const HelixDCAPrefilter& theTrackCircles1 = theTracks_sgn1.circles();
+  const HelixDCAPrefilter& theTrackCircles2 = theTracks_sgn2.circles();
+
+  // For wrong-sign candidates both lists are the same, and the second
+  //  tracks are approached to the first one exactly like the third ones
+  const bool sameLists = (&theTracks_sgn1 == &theTracks_sgn2);
+  std::atomic<unsigned long> nApproaches(0);
+  std::atomic<unsigned long> nApproachesReused(0);
+
+  // Candidates built around one first track. Everything shared between
+  //  the calls is only read, so the first tracks can be processed as
+  //  independent tasks.
+  auto fitFirstTrack = [&](unsigned int trdx1, reco::VertexCompositeCandidateCollection& theCandidates) {
+
+    std::vector<unsigned int> survivors2;
+    std::vector<unsigned int> survivors3;
+    std::vector<LamC3PSeed> pairSeeds;
+    std::vector<TripletSeed> tripletSeeds;
+    MassHypothesisFilter<2> pairMassFilter(thePairMassFilter);
+    MassHypothesisFilter<3> tripletMassFilter(theTripletMassFilter);
+    ApproachMemo approaches1;
+    ApproachMemo approaches2;
+    unsigned long nEvaluated = 0;
+    unsigned long nReused = 0;
+
+    if( !theTrackStates1.isValid(trdx1) ) return;
+
+    // the DCA between the first and the third track does not depend on the second one
+    const HelixDCAPrefilter::Circle& circle1 = theTrackCircles1.circleAt(trdx1);
+    survivors2.clear();
+    theTrackCircles1.select(circle1, trdx1 + 1, theTracks_sgn1.size(), tkDCACut, 0., survivors2);
+    survivors3.clear();
+    theTrackCircles2.select(circle1, 0, theTracks_sgn2.size(), tkDCACut, 0., survivors3);
+
+    const TransientTrack* transTkPtr1 = &theTracks_sgn1.transTrack(trdx1);
+    const FreeTrajectoryState& trkState1 = theTrackStates1.state(trdx1);
+
+    if( !sameLists ) approaches1.reset(theTracks_sgn1.size());
+    approaches2.reset(theTracks_sgn2.size());
+    ApproachMemo& pairApproaches = sameLists ? approaches2 : approaches1;
+
+    // Closest approach of the first track with track indx of a list
+    auto closestApproach = [&](ApproachMemo& memo, const PreselectedTrackStore& tracks,
+                               unsigned int indx) -> const ApproachMemo::Approach& {
+      const ApproachMemo::Approach* cached = memo.find(indx);
+      if( cached ) {
+        nReused++;
+        return *cached;
+      }
+      nEvaluated++;
+
+      ApproachMemo::Approach& approach = memo.insert(indx);
+      approach.pass = false;
+
+      // Measure distance between tracks at their closest approach
+      ClosestApproachInRPhi cApp;
+      cApp.calculate(trkState1, tracks.states().state(indx));
+      if( !cApp.status() ) return approach;
+      float dca = fabs( cApp.distance() );
+      if (dca < 0. || dca > tkDCACut) return approach;
+
+      approach.pass = true;
+      approach.cxPt = cApp.crossingPoint();
+      approach.trkTSCP = tracks.transTrack(indx).trajectoryStateClosestToPoint( approach.cxPt );
+      return approach;
+    };
+
+    // First pass: closest approach and momenta at the crossing point for
+    //  all second tracks, the mass windows are then tested on the whole block
+    pairSeeds.clear();
+    pairMassFilter.clear();
+
+    for(unsigned int isurv2 = 0; isurv2 < survivors2.size(); isurv2++) {
+
+      const unsigned int trdx2 = survivors2[isurv2];
+      if( !theTrackStates1.isValid(trdx2) ) continue;
+
+      const ApproachMemo::Approach& approach = closestApproach(pairApproaches, theTracks_sgn1, trdx2);
+      if( !approach.pass ) continue;
+
+      // Get trajectory states for the tracks at POCA for later cuts
+      LamC3PSeed seed;
+      seed.indx = trdx2;
+      seed.trkTSCP1 = transTkPtr1->trajectoryStateClosestToPoint( approach.cxPt );
+      seed.trkTSCP2 = approach.trkTSCP;
+
+      if( !seed.trkTSCP1.isValid() || !seed.trkTSCP2.isValid() ) continue;
+
+      const GlobalVector dauMomenta[2] = {seed.trkTSCP1.momentum(), seed.trkTSCP2.momentum()};
+      pairMassFilter.push_back(dauMomenta);
+      pairSeeds.push_back(seed);
+    }
+
+    // p-pi and pi-p mass windows
+    const std::vector<char>& passPairMass = pairMassFilter.select();
+
+    for(unsigned int ipair = 0; ipair < pairSeeds.size(); ipair++) {
+
+      if( !passPairMass[ipair] ) continue;
+
+      const unsigned int trdx2 = pairSeeds[ipair].indx;
+      const TrajectoryStateClosestToPoint& trkTSCP1 = pairSeeds[ipair].trkTSCP1;
+      const TrajectoryStateClosestToPoint& trkTSCP2 = pairSeeds[ipair].trkTSCP2;
 
-    for(unsigned int trdx2 = trdx1 + 1; trdx2 < theTrackRefs_sgn1.size(); trdx2++) {
 //      if( (theTrackRefs[trdx1]->pt() + theTrackRefs[trdx2]->pt()) < tkPtSumCut) continue;
 //      if( abs(theTrackRefs[trdx1]->eta() - theTrackRefs[trdx2]->eta()) > tkEtaDiffCut) continue;
 
       //This vector holds the pair of oppositely-charged tracks to be vertexed
       std::vector<TransientTrack> transTracks;
 
-      TrackRef trackRef1 = theTrackRefs_sgn1[trdx1];
-      TrackRef trackRef2 = theTrackRefs_sgn1[trdx2];
-      TransientTrack* transTkPtr1 = &theTransTracks_sgn1[trdx1];
-      TransientTrack* transTkPtr2 = &theTransTracks_sgn1[trdx2];
+      TrackRef trackRef1 = theTracks_sgn1.ref(trdx1);
+      TrackRef trackRef2 = theTracks_sgn1.ref(trdx2);
+      const TransientTrack* transTkPtr2 = &theTracks_sgn1.transTrack(trdx2);
 
 //      double dzvtx1 = trackRef1->dz(bestvtx);
 //      double dxyvtx1 = trackRef1->dxy(bestvtx);
@@ -327,53 +533,63 @@ void LamC3PFitter::fitLamCCandidates(
       transTracks.push_back(*transTkPtr1);
       transTracks.push_back(*transTkPtr2);
 
-      // Trajectory states to calculate DCA for the 2 tracks
-      FreeTrajectoryState trkState1 = transTkPtr1->impactPointTSCP().theState();
-      FreeTrajectoryState trkState2 = transTkPtr2->impactPointTSCP().theState();
-
-      if( !transTkPtr1->impactPointTSCP().isValid() || !transTkPtr2->impactPointTSCP().isValid() ) continue;
-
-      // Measure distance between tracks at their closest approach
-      ClosestApproachInRPhi cApp;
-      cApp.calculate(trkState1, trkState2);
-      if( !cApp.status() ) continue;
-      float dca = fabs( cApp.distance() );
-      GlobalPoint cxPt = cApp.crossingPoint();
-
-      if (dca < 0. || dca > tkDCACut) continue;
+      // Momentum budget of the third track in the p-pi-K and pi-p-K windows.
+      //  |p| is conserved along the helix, so the third tracks outside of it
+      //  cannot pass the three-body mass cut and are skipped before the DCA.
+      const std::pair<double, double> p3RangePPi =
+        thirdMomentumRange(trkTSCP1.momentum(), protonMassLamC3P, trkTSCP2.momentum(), piMassLamC3P,
+                           kaonMassLamC3P, mPiKPCutMin, mPiKPCutMax);
+      const std::pair<double, double> p3RangePiP =
+        thirdMomentumRange(trkTSCP1.momentum(), piMassLamC3P, trkTSCP2.momentum(), protonMassLamC3P,
+                           kaonMassLamC3P, mPiKPCutMin, mPiKPCutMax);
+      const double p3Min = std::min(p3RangePPi.first, p3RangePiP.first);
+      const double p3Max = std::max(p3RangePPi.second, p3RangePiP.second);
+      if( p3Max < p3Min ) continue;
+
+      // First pass: closest approach of the third track to the first one,
+      //  the three-body mass windows are then tested on the whole block
+      tripletSeeds.clear();
+      tripletMassFilter.clear();
+
+      for(unsigned int isurv3 = 0; isurv3 < survivors3.size(); isurv3++) {
+
+        const unsigned int trdx3 = survivors3[isurv3];
+        const double p3 = theTracks_sgn2.ref(trdx3)->p();
+        if( p3 < p3Min || p3 > p3Max ) continue;
+        if( !theTrackStates2.isValid(trdx3) ) continue;
+
+        const ApproachMemo::Approach& approach13 = closestApproach(approaches2, theTracks_sgn2, trdx3);
+        if( !approach13.pass ) continue;
 
-      // Get trajectory states for the tracks at POCA for later cuts
-      TrajectoryStateClosestToPoint trkTSCP1 =
-        transTkPtr1->trajectoryStateClosestToPoint( cxPt );
-      TrajectoryStateClosestToPoint trkTSCP2 =
-        transTkPtr2->trajectoryStateClosestToPoint( cxPt );
+        // Get trajectory states for the tracks at POCA for later cuts
+        TripletSeed seed;
+        seed.indx = trdx3;
+        seed.trkTSCP31 = approach13.trkTSCP;
 
-      if( !trkTSCP1.isValid() || !trkTSCP2.isValid() ) continue;
+        if( !seed.trkTSCP31.isValid() ) continue;
 
-      double totalE1 = sqrt( trkTSCP1.momentum().mag2() + protonMassLamC3PSquared ) +
-                      sqrt( trkTSCP2.momentum().mag2() + piMassLamC3PSquared );
-      double totalE1Sq = totalE1*totalE1;
+        const GlobalVector dauMomenta[3] = {trkTSCP1.momentum(), trkTSCP2.momentum(), seed.trkTSCP31.momentum()};
+        tripletMassFilter.push_back(dauMomenta);
+        tripletSeeds.push_back(seed);
+      }
 
-      double totalE2 = sqrt( trkTSCP1.momentum().mag2() + piMassLamC3PSquared ) +
-                      sqrt( trkTSCP2.momentum().mag2() + protonMassLamC3PSquared );
-      double totalE2Sq = totalE2*totalE2;
+      // p-pi-K and pi-p-K mass windows
+      const std::vector<char>& passTripletMass = tripletMassFilter.select();
 
-      double totalPSq =
-        ( trkTSCP1.momentum() + trkTSCP2.momentum() ).mag2();
+      for(unsigned int itriplet = 0; itriplet < tripletSeeds.size(); itriplet++) {
 
-//      double totalPt =
-//        ( trkTSCP1.momentum() + trkTSCP2.momentum() ).perp();
+        if( !passTripletMass[itriplet] ) continue;
 
-      double mass1 = sqrt( totalE1Sq - totalPSq);
-      double mass2 = sqrt( totalE2Sq - totalPSq);
+        const unsigned int trdx3 = tripletSeeds[itriplet].indx;
+        const TrajectoryStateClosestToPoint& trkTSCP31 = tripletSeeds[itriplet].trkTSCP31;
 
-      if( (mass1 > mKPCutMax || mass1 < mKPCutMin) && (mass2 > mKPCutMax || mass2 < mKPCutMin)) continue;
-//      if( totalPt < dPtCut ) continue;
+        double totalPt3 =
+          ( trkTSCP1.momentum() + trkTSCP2.momentum() + trkTSCP31.momentum()).perp();
 
-      for(unsigned int trdx3 = 0; trdx3 < theTrackRefs_sgn2.size(); trdx3++) {
+        if( totalPt3 < dPt3Cut ) continue;
 
-        TrackRef trackRef3 = theTrackRefs_sgn2[trdx3];
-        TransientTrack* transTkPtr3 = &theTransTracks_sgn2[trdx3];
+        TrackRef trackRef3 = theTracks_sgn2.ref(trdx3);
+        const TransientTrack* transTkPtr3 = &theTracks_sgn2.transTrack(trdx3);
   
 //        double dzvtx3 = trackRef3->dz(bestvtx);
 //        double dxyvtx3 = trackRef3->dxy(bestvtx);
@@ -386,44 +602,6 @@ void LamC3PFitter::fitLamCCandidates(
 //        double ptErr3 = trackRef3->ptError();
 
         transTracks.push_back(*transTkPtr3);
-        FreeTrajectoryState trkState3 = transTkPtr3->impactPointTSCP().theState();
-        if( !transTkPtr3->impactPointTSCP().isValid() ) continue;
-
-        // Measure distance between tracks at their closest approach
-        ClosestApproachInRPhi cApp13;
-        cApp13.calculate(trkState1, trkState3);
-        if( !cApp13.status() ) continue;
-        float dca13 = fabs( cApp13.distance() );
-        GlobalPoint cxPt13 = cApp13.crossingPoint();
-        if (dca13 < 0. || dca13 > tkDCACut) continue;
-
-        // Get trajectory states for the tracks at POCA for later cuts
-        TrajectoryStateClosestToPoint trkTSCP31 =
-          transTkPtr3->trajectoryStateClosestToPoint( cxPt13 );
-
-        if( !trkTSCP31.isValid() ) continue;
-
-        double totalE31 = sqrt( trkTSCP1.momentum().mag2() + protonMassLamC3PSquared ) +
-                          sqrt( trkTSCP2.momentum().mag2() + piMassLamC3PSquared ) + 
-                          sqrt( trkTSCP31.momentum().mag2() + kaonMassLamC3PSquared );
-        double totalE31Sq = totalE31*totalE31;
-
-        double totalE32 = sqrt( trkTSCP1.momentum().mag2() + piMassLamC3PSquared ) +
-                          sqrt( trkTSCP2.momentum().mag2() + protonMassLamC3PSquared ) + 
-                          sqrt( trkTSCP31.momentum().mag2() + kaonMassLamC3PSquared );
-        double totalE32Sq = totalE32*totalE32;
-
-        double totalP3Sq =
-          ( trkTSCP1.momentum() + trkTSCP2.momentum() + trkTSCP31.momentum()).mag2();
-
-        double totalPt3 =
-          ( trkTSCP1.momentum() + trkTSCP2.momentum() + trkTSCP31.momentum()).perp();
-
-        double mass31 = sqrt( totalE31Sq - totalP3Sq);
-        double mass32 = sqrt( totalE32Sq - totalP3Sq);
-
-        if( (mass31 > mPiKPCutMax || mass31 < mPiKPCutMin) && (mass32 > mPiKPCutMax || mass32 < mPiKPCutMin)) continue;
-        if( totalPt3 < dPt3Cut ) continue;
 
         // Create the vertex fitter object and vertex the tracks
         float cand1TotalE[2]={0.0};
@@ -569,7 +747,7 @@ void LamC3PFitter::fitLamCCandidates(
               theLamC3P->mass() > lamCMassLamC3P - lamCMassCut ) //&&
 	     // theLamC3P->pt() > dPtCut ) {
           {
-            theLamC3Ps.push_back( *theLamC3P );
+            theCandidates.push_back( *theLamC3P );
           }
 // perform MVA evaluation
 /*
@@ -612,7 +790,32 @@ void LamC3PFitter::fitLamCCandidates(
         } // swap mass
       } // trk3 
     }  // trk2
-  } // trk1
+
+    nApproaches += nEvaluated;
+    nApproachesReused += nReused;
+  };
+
+  if( parallelPairLoop ) {
+    // one buffer per first track, merged in track order so that the
+    //  collection is identical to the serial one. The triplet lists vary a
+    //  lot in length, so the tasks are small and left to work stealing.
+    std::vector<reco::VertexCompositeCandidateCollection> theBuffers(theTracks_sgn1.size());
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, theTracks_sgn1.size(), pairLoopGrainSize),
+                      [&](const tbb::blocked_range<unsigned int>& range) {
+                        for(unsigned int trdx1 = range.begin(); trdx1 != range.end(); trdx1++) {
+                          fitFirstTrack(trdx1, theBuffers[trdx1]);
+                        }
+                      });
+    for(unsigned int trdx1 = 0; trdx1 < theBuffers.size(); trdx1++) {
+      theLamC3Ps.insert(theLamC3Ps.end(), theBuffers[trdx1].begin(), theBuffers[trdx1].end());
+    }
+  }
+  else {
+    for(unsigned int trdx1 = 0; trdx1 < theTracks_sgn1.size(); trdx1++) fitFirstTrack(trdx1, theLamC3Ps);
+  }
+
+  LogDebug("LamC3PFitter") << "closest approaches with the first track: " << nApproaches.load()
+                           << " evaluated, " << nApproachesReused.load() << " reused";
 
 //  mvaFiller.insert(theLamC3Ps,mvaVals_.begin(),mvaVals_.end());
 //  mvaFiller.fill();
@@ -629,6 +832,18 @@ const std::vector<float>& LamC3PFitter::getMVAVals() const {
   return mvaVals_;
 }
 
+std::unique_ptr<reco::VertexCompositeCandidateCollection> LamC3PFitter::releaseLamC3P() {
+  std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+  theReleased->swap(theLamC3Ps);
+  return theReleased;
+}
+
+std::unique_ptr<std::vector<float> > LamC3PFitter::releaseMVAVals() {
+  std::unique_ptr<std::vector<float> > theReleased(new std::vector<float>);
+  theReleased->swap(mvaVals_);
+  return theReleased;
+}
+
 /*
 auto_ptr<edm::ValueMap<float> > LamC3PFitter::getMVAMap() const {
   return mvaValValueMap;
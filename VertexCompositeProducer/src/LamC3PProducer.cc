@@ -55,19 +55,14 @@ void LamC3PProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 //   std::auto_ptr< reco::VertexCompositeCandidateCollection >
 //     lamCCandidates( new reco::VertexCompositeCandidateCollection );
 //
-   auto lamCCandidates = std::make_unique<reco::VertexCompositeCandidateCollection>();
-   lamCCandidates->reserve( theVees.getLamC3P().size() );
-
-   std::copy( theVees.getLamC3P().begin(),
-              theVees.getLamC3P().end(),
-              std::back_inserter(*lamCCandidates) );
+   auto lamCCandidates = theVees.releaseLamC3P();
 
    // Write the collections to the Event
    iEvent.put( std::move(lamCCandidates), std::string("LamC3P") );
     
    if(useAnyMVA_) 
    {
-     auto mvas = std::make_unique<MVACollection>(theVees.getMVAVals().begin(),theVees.getMVAVals().end());
+     auto mvas = theVees.releaseMVAVals();
      iEvent.put(std::move(mvas), std::string("MVAValuesLamC3P"));
    }
 
@@ -0,0 +1,99 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      PairVertexFitter
+//
+/**\class PairVertexFitter PairVertexFitter.cc VertexCompositeAnalysis/VertexCompositeProducer/src/PairVertexFitter.cc
+
+ Description: vertex fit of an opposite-sign track pair
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/PairVertexFitter.h"
+
+#include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
+#include "RecoVertex/AdaptiveVertexFit/interface/AdaptiveVertexFitter.h"
+#include "DataFormats/GeometryCommonDetAlgo/interface/GlobalError.h"
+
+namespace {
+
+  class KalmanPairVertexFitter : public PairVertexFitter {
+   public:
+    explicit KalmanPairVertexFitter(bool useRefTrax) : theFitter(useRefTrax), useRefTrax_(useRefTrax) {}
+
+    TransientVertex vertex(const std::vector<reco::TransientTrack>& theTracks,
+                           const TrajectoryStateClosestToPoint&,
+                           const TrajectoryStateClosestToPoint&) const override {
+      return theFitter.vertex(theTracks);
+    }
+
+    PairVertexFitter* clone() const override { return new KalmanPairVertexFitter(useRefTrax_); }
+
+    bool providesRefittedTracks() const override { return useRefTrax_; }
+
+   private:
+    KalmanVertexFitter theFitter;
+    bool useRefTrax_;
+  };
+
+  class AdaptivePairVertexFitter : public PairVertexFitter {
+   public:
+    AdaptivePairVertexFitter() {}
+
+    TransientVertex vertex(const std::vector<reco::TransientTrack>& theTracks,
+                           const TrajectoryStateClosestToPoint&,
+                           const TrajectoryStateClosestToPoint&) const override {
+      return theFitter.vertex(theTracks);
+    }
+
+    PairVertexFitter* clone() const override { return new AdaptivePairVertexFitter(); }
+
+   private:
+    AdaptiveVertexFitter theFitter;
+  };
+
+  // Combines the two track points closest to the crossing point with their
+  //  position covariances. The single-track covariances are singular along
+  //  the track direction, so the mean is written with (C1+C2)^-1 only:
+  //    x = x1 + C1 (C1+C2)^-1 (x2-x1),  C = C1 - C1 (C1+C2)^-1 C1
+  class AnalyticPairVertexFitter : public PairVertexFitter {
+   public:
+    AnalyticPairVertexFitter() {}
+
+    TransientVertex vertex(const std::vector<reco::TransientTrack>& theTracks,
+                           const TrajectoryStateClosestToPoint& posTSCP,
+                           const TrajectoryStateClosestToPoint& negTSCP) const override {
+      if( !posTSCP.isValid() || !negTSCP.isValid() ||
+          !posTSCP.hasError() || !negTSCP.hasError() ) return TransientVertex();
+
+      const GlobalPoint posPoint = posTSCP.position();
+      const GlobalPoint negPoint = negTSCP.position();
+      const AlgebraicSymMatrix33 posCov = posTSCP.theState().cartesianError().position().matrix();
+      const AlgebraicSymMatrix33 negCov = negTSCP.theState().cartesianError().position().matrix();
+
+      AlgebraicSymMatrix33 sumInv = posCov + negCov;
+      if( !sumInv.Invert() ) return TransientVertex();
+
+      AlgebraicVector3 diff(negPoint.x() - posPoint.x(),
+                            negPoint.y() - posPoint.y(),
+                            negPoint.z() - posPoint.z());
+      const AlgebraicVector3 shift = posCov * (sumInv * diff);
+      const GlobalPoint vtxPos(posPoint.x() + shift[0], posPoint.y() + shift[1], posPoint.z() + shift[2]);
+      const AlgebraicSymMatrix33 vtxCov = posCov - ROOT::Math::Similarity(posCov, sumInv);
+      const float chi2 = ROOT::Math::Similarity(diff, sumInv);
+
+      return TransientVertex(vtxPos, GlobalError(vtxCov), theTracks, chi2, 1.);
+    }
+
+    PairVertexFitter* clone() const override { return new AnalyticPairVertexFitter(); }
+  };
+}
+
+std::unique_ptr<PairVertexFitter> PairVertexFitter::create(const std::string& label, bool useRefTrax) {
+  std::unique_ptr<PairVertexFitter> theFitter;
+  if( label == "KalmanVertexFitter" ) theFitter.reset(new KalmanPairVertexFitter(useRefTrax));
+  else if( label == "AdaptiveVertexFitter" ) theFitter.reset(new AdaptivePairVertexFitter());
+  else if( label == "AnalyticVertexFitter" ) theFitter.reset(new AnalyticPairVertexFitter());
+  return theFitter;
+}
@@ -0,0 +1,148 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+//
+// Class:      PreselectedTrackProducer
+// 
+/**\class PreselectedTrackProducer PreselectedTrackProducer.cc VertexCompositeAnalysis/VertexCompositeProducer/src/PreselectedTrackProducer.cc
+
+ Description: table of the tracks passing a loose preselection, shared by
+              the candidate producers of one path
+
+ Implementation:
+     See the header
+*/
+//
+//
+
+
+// system include files
+#include <memory>
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/PreselectedTrackProducer.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+// Constructor
+PreselectedTrackProducer::PreselectedTrackProducer(const edm::ParameterSet& iConfig) {
+  using std::string;
+
+  token_beamSpot = consumes<reco::BeamSpot>(edm::InputTag("offlineBeamSpot"));
+  token_tracks = consumes<reco::TrackCollection>(iConfig.getParameter<edm::InputTag>("trackRecoAlgorithm"));
+  token_vertices = consumes<reco::VertexCollection>(iConfig.getParameter<edm::InputTag>("vertexRecoAlgorithm"));
+
+  theCuts.chi2Cut = iConfig.getParameter<double>(string("tkChi2Cut"));
+  theCuts.nhitsCut = iConfig.getParameter<int>(string("tkNhitsCut"));
+  theCuts.ptErrCut = iConfig.getParameter<double>(string("tkPtErrCut"));
+  theCuts.ptCut = iConfig.getParameter<double>(string("tkPtCut"));
+  theCuts.etaCut = iConfig.getParameter<double>(string("tkEtaCut"));
+  theCuts.transImpactSigCut = iConfig.getParameter<double>(string("dauTransImpactSigCut"));
+  theCuts.longImpactSigCut = iConfig.getParameter<double>(string("dauLongImpactSigCut"));
+
+  std::vector<std::string> qual = iConfig.getParameter<std::vector<std::string> >("trackQualities");
+  for (unsigned int ndx = 0; ndx < qual.size(); ndx++) {
+    theCuts.qualities.push_back(reco::TrackBase::qualityByName(qual[ndx]));
+  }
+
+  produces< reco::TrackRefVector >();
+  produces< SignificanceCollection >("dauTransImpactSig");
+  produces< SignificanceCollection >("dauLongImpactSig");
+  produces< SignificanceCollection >("bestVertex");
+}
+
+// (Empty) Destructor
+PreselectedTrackProducer::~PreselectedTrackProducer() {
+}
+
+
+//
+// Methods
+//
+
+// Producer Method
+void PreselectedTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
+  using namespace edm;
+  using reco::TrackRef;
+
+  Handle<reco::TrackCollection> theTrackHandle;
+  Handle<reco::VertexCollection> theVertexHandle;
+  Handle<reco::BeamSpot> theBeamSpotHandle;
+
+  iEvent.getByToken(token_tracks, theTrackHandle);
+  iEvent.getByToken(token_vertices, theVertexHandle);
+  iEvent.getByToken(token_beamSpot, theBeamSpotHandle);
+
+  auto theTracks = std::make_unique<reco::TrackRefVector>();
+  auto theTransImpactSigs = std::make_unique<SignificanceCollection>();
+  auto theLongImpactSigs = std::make_unique<SignificanceCollection>();
+  auto theBestVertex = std::make_unique<SignificanceCollection>();
+
+  // Same best vertex as in the fitters
+  double xVtx=-99999.0;
+  double yVtx=-99999.0;
+  double zVtx=-99999.0;
+  double xVtxError=-999.0;
+  double yVtxError=-999.0;
+  double zVtxError=-999.0;
+  const reco::VertexCollection& vtxCollection = *(theVertexHandle.product());
+  reco::VertexCollection::const_iterator vtxPrimary = vtxCollection.begin();
+  if(vtxCollection.size()>0 && !vtxPrimary->isFake() && vtxPrimary->tracksSize()>=2)
+  {
+    xVtx = vtxPrimary->x();
+    yVtx = vtxPrimary->y();
+    zVtx = vtxPrimary->z();
+    xVtxError = vtxPrimary->xError();
+    yVtxError = vtxPrimary->yError();
+    zVtxError = vtxPrimary->zError();
+  }
+  else {
+    xVtx = theBeamSpotHandle->position().x();
+    yVtx = theBeamSpotHandle->position().y();
+    zVtx = 0.0;
+    xVtxError = theBeamSpotHandle->BeamWidthX();
+    yVtxError = theBeamSpotHandle->BeamWidthY();
+    zVtxError = 0.0;
+  }
+  math::XYZPoint bestvtx(xVtx,yVtx,zVtx);
+  math::XYZPoint bestvtxError(xVtxError,yVtxError,zVtxError);
+
+  // Checked by the fitters reading the table
+  theBestVertex->push_back(xVtx);
+  theBestVertex->push_back(yVtx);
+  theBestVertex->push_back(zVtx);
+  theBestVertex->push_back(xVtxError);
+  theBestVertex->push_back(yVtxError);
+  theBestVertex->push_back(zVtxError);
+
+  for(unsigned int indx = 0; indx < theTrackHandle->size(); indx++) {
+    TrackRef tmpRef( theTrackHandle, indx );
+    if( !theCuts.passTrack(*tmpRef) ) continue;
+
+    double dauTransImpactSig, dauLongImpactSig;
+    TrackPreselection::impactSignificances(*tmpRef, bestvtx, bestvtxError, dauTransImpactSig, dauLongImpactSig);
+    if( theCuts.passImpact(dauTransImpactSig, dauLongImpactSig) ) {
+      theTracks->push_back( tmpRef );
+      theTransImpactSigs->push_back( dauTransImpactSig );
+      theLongImpactSigs->push_back( dauLongImpactSig );
+    }
+  }
+
+  LogDebug("PreselectedTrackProducer") << theTracks->size() << " of " << theTrackHandle->size() << " tracks preselected";
+
+  iEvent.put( std::move(theTracks) );
+  iEvent.put( std::move(theTransImpactSigs), std::string("dauTransImpactSig") );
+  iEvent.put( std::move(theLongImpactSigs), std::string("dauLongImpactSig") );
+  iEvent.put( std::move(theBestVertex), std::string("bestVertex") );
+}
+
+
+void PreselectedTrackProducer::beginJob() {
+}
+
+
+void PreselectedTrackProducer::endJob() {
+}
+
+//define this as a plug-in
+#include "FWCore/PluginManager/interface/ModuleDef.h"
+
+DEFINE_FWK_MODULE(PreselectedTrackProducer);
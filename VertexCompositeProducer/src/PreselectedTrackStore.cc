@@ -0,0 +1,32 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      PreselectedTrackStore
+//
+/**\class PreselectedTrackStore PreselectedTrackStore.cc VertexCompositeAnalysis/VertexCompositeProducer/src/PreselectedTrackStore.cc
+
+ Description: per-event store of the preselected tracks of one charge
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/PreselectedTrackStore.h"
+
+void PreselectedTrackStore::clear() {
+  theRefs.clear();
+  theTransTracks.clear();
+  theStates.clear();
+  theCircles.fill(theStates);
+}
+
+void PreselectedTrackStore::push_back(const reco::TrackRef& theRef, const reco::TransientTrack& theTransTrack) {
+  theRefs.push_back( theRef );
+  theTransTracks.push_back( theTransTrack );
+}
+
+void PreselectedTrackStore::fillStates() {
+  theStates.clear();
+  theStates.reserve(theTransTracks.size());
+  for(unsigned int indx = 0; indx < theTransTracks.size(); indx++) theStates.push_back(theTransTracks[indx]);
+  theCircles.fill(theStates);
+}
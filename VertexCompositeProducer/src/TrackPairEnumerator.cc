@@ -0,0 +1,96 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      TrackPairEnumerator
+//
+/**\class TrackPairEnumerator TrackPairEnumerator.cc VertexCompositeAnalysis/VertexCompositeProducer/src/TrackPairEnumerator.cc
+
+ Description: charge-partitioned, momentum-sorted enumeration of
+              opposite-sign track pairs
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackPairEnumerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+  // Relative slack on the momentum bounds. The mass cuts in the fitters use
+  // float momenta at the crossing point, so the ranges must never be tight.
+  const double momentumTolerance = 1.e-3;
+
+  struct MomentumOrder {
+    const std::vector<reco::TrackRef>& refs;
+    bool operator()(unsigned int a, unsigned int b) const {
+      return refs[a]->p() < refs[b]->p();
+    }
+  };
+}
+
+TrackPairEnumerator::TrackPairEnumerator() {
+}
+
+void TrackPairEnumerator::addMassWindow(double dauMass, double mMin, double mMax) {
+  MassWindow window;
+  window.mass = dauMass;
+  window.isEmpty = (mMax < 2.*dauMass);
+  window.maxRapDiff = window.isEmpty ? 0. : 2.*std::acosh(mMax/(2.*dauMass));
+  window.hasMinSum = (mMin > 2.*dauMass);
+  window.minRapSum = window.hasMinSum ? 2.*std::acosh(mMin/(2.*dauMass)) : 0.;
+  theWindows.push_back(window);
+}
+
+void TrackPairEnumerator::clear() {
+  thePositives.clear();
+  theNegatives.clear();
+  thePosMomenta.clear();
+  theNegMomenta.clear();
+}
+
+void TrackPairEnumerator::fill(const std::vector<reco::TrackRef>& theTrackRefs) {
+  clear();
+
+  for(unsigned int indx = 0; indx < theTrackRefs.size(); indx++) {
+    if(theTrackRefs[indx]->charge() > 0) thePositives.push_back(indx);
+    else if(theTrackRefs[indx]->charge() < 0) theNegatives.push_back(indx);
+  }
+
+  MomentumOrder order = {theTrackRefs};
+  std::stable_sort(thePositives.begin(), thePositives.end(), order);
+  std::stable_sort(theNegatives.begin(), theNegatives.end(), order);
+
+  thePosMomenta.reserve(thePositives.size());
+  for(unsigned int i = 0; i < thePositives.size(); i++) thePosMomenta.push_back(theTrackRefs[thePositives[i]]->p());
+  theNegMomenta.reserve(theNegatives.size());
+  for(unsigned int i = 0; i < theNegatives.size(); i++) theNegMomenta.push_back(theTrackRefs[theNegatives[i]]->p());
+}
+
+std::pair<unsigned int, unsigned int> TrackPairEnumerator::partners(unsigned int iPos) const {
+  double pLow = 0.;
+  double pHigh = std::numeric_limits<double>::max();
+
+  const double p1 = thePosMomenta[iPos];
+  for(unsigned int iw = 0; iw < theWindows.size(); iw++) {
+    const MassWindow& window = theWindows[iw];
+    if(window.isEmpty) return std::make_pair(0u, 0u);
+
+    const double y1 = std::asinh(p1/window.mass);
+    double yLow = y1 - window.maxRapDiff;
+    if(window.hasMinSum) yLow = std::max(yLow, window.minRapSum - y1);
+    const double yHigh = y1 + window.maxRapDiff;
+
+    if(yLow > 0.) pLow = std::max(pLow, window.mass*std::sinh(yLow));
+    pHigh = std::min(pHigh, window.mass*std::sinh(yHigh));
+  }
+
+  pLow *= (1. - momentumTolerance);
+  pHigh *= (1. + momentumTolerance);
+  if(pHigh < pLow) return std::make_pair(0u, 0u);
+
+  const unsigned int first = std::lower_bound(theNegMomenta.begin(), theNegMomenta.end(), pLow) - theNegMomenta.begin();
+  const unsigned int last = std::upper_bound(theNegMomenta.begin(), theNegMomenta.end(), pHigh) - theNegMomenta.begin();
+  return std::make_pair(first, std::max(first, last));
+}
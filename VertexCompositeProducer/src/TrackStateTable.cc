@@ -0,0 +1,44 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+// Class:      TrackStateTable
+//
+/**\class TrackStateTable TrackStateTable.cc VertexCompositeAnalysis/VertexCompositeProducer/src/TrackStateTable.cc
+
+ Description: per-event table of impact-point track states
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/TrackStateTable.h"
+#include "TrackingTools/TrajectoryState/interface/TrajectoryStateClosestToPoint.h"
+
+void TrackStateTable::clear() {
+  theStates.clear();
+  theMomenta.clear();
+  theCharges.clear();
+  theValid.clear();
+}
+
+void TrackStateTable::reserve(unsigned int n) {
+  theStates.reserve(n);
+  theMomenta.reserve(n);
+  theCharges.reserve(n);
+  theValid.reserve(n);
+}
+
+void TrackStateTable::push_back(const reco::TransientTrack& theTransTrack) {
+  const TrajectoryStateClosestToPoint& tscp = theTransTrack.impactPointTSCP();
+  if( tscp.isValid() ) {
+    theStates.push_back( tscp.theState() );
+    theMomenta.push_back( tscp.momentum() );
+    theValid.push_back( 1 );
+  }
+  else {
+    // keep the columns aligned with the TransientTrack vector
+    theStates.push_back( FreeTrajectoryState() );
+    theMomenta.push_back( GlobalVector() );
+    theValid.push_back( 0 );
+  }
+  theCharges.push_back( theTransTrack.charge() );
+}
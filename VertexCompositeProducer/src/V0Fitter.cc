@@ -28,6 +28,7 @@
 #include "RecoVertex/KinematicFitPrimitives/interface/MultiTrackKinematicConstraint.h"
 #include "RecoVertex/KinematicFit/interface/KinematicConstrainedVertexFitter.h"
 #include "RecoVertex/KinematicFit/interface/TwoTrackMassKinematicConstraint.h"
+#include "RecoVertex/KinematicFitPrimitives/interface/VirtualKinematicParticleFactory.h"
 #include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
 
 #include "DataFormats/BeamSpot/interface/BeamSpot.h"
@@ -38,9 +39,122 @@
 #include "TrackingTools/IPTools/interface/IPTools.h"
 #include "CommonTools/Statistics/interface/ChiSquaredProbability.h"
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
 #include <typeinfo>
 #include <memory>
 #include <vector>
+#include <iterator>
+
+namespace {
+  // Opposite-sign pair that passed the DCA and fiducial cuts, with the
+  //  daughter states at the crossing point
+  struct PairSeed {
+    unsigned int negIndx;
+    TrajectoryStateClosestToPoint posTSCP;
+    TrajectoryStateClosestToPoint negTSCP;
+  };
+
+  // Moves a collection out of the fitter without copying the candidates
+  std::unique_ptr<reco::VertexCompositeCandidateCollection>
+  releaseCollection(reco::VertexCompositeCandidateCollection& theCollection) {
+    std::unique_ptr<reco::VertexCompositeCandidateCollection> theReleased(new reco::VertexCompositeCandidateCollection);
+    theReleased->swap(theCollection);
+    return theReleased;
+  }
+
+  // Mass-constrained kinematic fit of a V0 used in the cascade stage. The
+  //  fit only depends on the V0, so it is done on first use and shared by
+  //  all bachelor tracks combined with it.
+  class ConstrainedV0Fit {
+   public:
+    ConstrainedV0Fit() : isDone(false), isValid(false) {}
+
+    // Returns false if the daughters or any of the two fits are invalid
+    bool fit(const reco::TransientTrack& dau1TT, ParticleMass dau1Mass, float dau1Sigma,
+             const reco::TransientTrack& dau2TT, ParticleMass dau2Mass, float dau2Sigma,
+             ParticleMass v0Mass, float v0Sigma) {
+      if( isDone ) return isValid;
+      isDone = true;
+
+      if (!dau1TT.isValid() || !dau2TT.isValid()) return false;
+
+      KinematicParticleFactoryFromTransientTrack pFactory;
+      float chi = 0.;
+      float ndf = 0.;
+      std::vector<RefCountedKinematicParticle> v0Particles;
+      v0Particles.push_back(pFactory.particle(dau1TT,dau1Mass,chi,ndf,dau1Sigma));
+      v0Particles.push_back(pFactory.particle(dau2TT,dau2Mass,chi,ndf,dau2Sigma));
+
+      KinematicParticleVertexFitter fitter;
+      RefCountedKinematicTree v0VertexFitTree = fitter.fit(v0Particles);
+      if (!v0VertexFitTree->isValid()) return false;
+
+      v0VertexFitTree->movePointerToTheTop();
+      theVertex = v0VertexFitTree->currentDecayVertex();
+
+      KinematicParticleFitter csFitter;
+      // the constrained tree keeps a pointer to its constraint
+      theConstraint.reset(new MassKinematicConstraint(v0Mass,v0Sigma));
+      v0VertexFitTree = csFitter.fit(theConstraint.get(),v0VertexFitTree);
+      if (!v0VertexFitTree->isValid()) return false;
+      v0VertexFitTree->movePointerToTheTop();
+      theParticle = v0VertexFitTree->currentParticle();
+      if (!theParticle->currentState().isValid()) return false;
+
+      theTree = v0VertexFitTree;
+      isValid = true;
+      return true;
+    }
+
+    // Mass-constrained V0, as a new particle on every call. The vertex
+    //  fitter attaches the tree of a virtual input particle to the tree it
+    //  builds, so every cascade fit needs its own particle instead of the
+    //  cached one.
+    RefCountedKinematicParticle particle() const {
+      VirtualKinematicParticleFactory vFactory;
+      float v0Chi2 = theParticle->chiSquared();
+      float v0Ndf = theParticle->degreesOfFreedom();
+      return vFactory.particle(theParticle->currentState(), v0Chi2, v0Ndf, theParticle);
+    }
+    // Decay vertex of the unconstrained fit
+    const RefCountedKinematicVertex& vertex() const { return theVertex; }
+
+   private:
+    bool isDone;
+    bool isValid;
+    std::unique_ptr<MassKinematicConstraint> theConstraint;
+    RefCountedKinematicTree theTree;
+    RefCountedKinematicParticle theParticle;
+    RefCountedKinematicVertex theVertex;
+  };
+
+  // Builds a two-body VertexCompositeCandidate directly at the end of the
+  //  collection and keeps it only if the mass set by AddFourMomenta is inside
+  //  (mass - massCut, mass + massCut). The summed daughter four-momentum is
+  //  checked first, so that no candidate is built and no daughter is cloned
+  //  for combinations outside the window.
+  void appendCandidate(reco::VertexCompositeCandidateCollection& theCollection,
+                       const reco::Particle::LorentzVector& p4, const reco::Particle::Point& vtx,
+                       const reco::Vertex::CovarianceMatrix& vtxCov, double vtxChi2, double vtxNdof,
+                       const reco::Candidate& dau1, const reco::Candidate& dau2, int pdgId,
+                       double mass, double massCut) {
+    const double sumMass = (dau1.p4() + dau2.p4()).M();
+    const double tolerance = 1.e-6*(mass + massCut);
+    if( sumMass > mass + massCut + tolerance || sumMass < mass - massCut - tolerance ) return;
+
+    theCollection.emplace_back(0, p4, vtx, vtxCov, vtxChi2, vtxNdof);
+    reco::VertexCompositeCandidate& theCand = theCollection.back();
+    theCand.addDaughter(dau1);
+    theCand.addDaughter(dau2);
+    theCand.setPdgId(pdgId);
+    AddFourMomenta addp4;
+    addp4.set( theCand );
+    if( !( theCand.mass() < mass + massCut &&
+           theCand.mass() > mass - massCut ) ) theCollection.pop_back();
+  }
+}
 
 const ParticleMass piMass = 0.13957018;
 const double piMassSquared = piMass*piMass;
@@ -108,6 +222,9 @@ V0Fitter::V0Fitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollect
   doLambdaCToKsPs = theParameters.getParameter<bool>(string("selectLambdaCToKsPs"));
 
   doVertexFit = theParameters.getParameter<bool>(string("doVertexFit"));
+  //  -whether to run the pair loop as parallel tasks
+  parallelPairLoop = false;
+  if(theParameters.exists("parallelPairLoop")) parallelPairLoop = theParameters.getParameter<bool>("parallelPairLoop");
 
   // Second, initialize post-fit cuts
   tkDCACut = theParameters.getParameter<double>(string("tkDCACut"));
@@ -147,11 +264,32 @@ V0Fitter::V0Fitter(const edm::ParameterSet& theParameters,  edm::ConsumesCollect
   mKKCutMax = theParameters.getParameter<double>(string("mKKCutMax"));
   vtxFitter = theParameters.getParameter<edm::InputTag>("vertexFitter");
   innerHitPosCut = theParameters.getParameter<double>(string("innerHitPosCut"));
+
+  // The vertex fitting strategy is fixed for the job
+  theVertexFitter = PairVertexFitter::create(vtxFitter.label(), useRefTrax);
   std::vector<std::string> qual = theParameters.getParameter<std::vector<std::string> >("trackQualities");
   for (unsigned int ndx = 0; ndx < qual.size(); ndx++) {
     qualities.push_back(reco::TrackBase::qualityByName(qual[ndx]));
   }
 
+  TrackPreselection::Cuts trackCuts;
+  trackCuts.qualities = qualities;
+  trackCuts.chi2Cut = tkChi2Cut;
+  trackCuts.nhitsCut = tkNhitsCut;
+  trackCuts.ptCut = tkPtCut;
+  trackCuts.transImpactSigCut = dauTransImpactSigCut;
+  trackCuts.longImpactSigCut = dauLongImpactSigCut;
+  thePreselection.setup(theParameters, iC, trackCuts);
+
+  thePairEnumerator.addMassWindow(piMass, mPiPiCutMin, mPiPiCutMax);
+  thePairEnumerator.addMassWindow(kaonMass, mKKCutMin, mKKCutMax);
+
+  const double piPiMassesSquared[2] = {piMassSquared, piMassSquared};
+  const double kKMassesSquared[2] = {kaonMassSquared, kaonMassSquared};
+  thePairMassFilter.setRequireAll(true);
+  thePairMassFilter.addHypothesis(piPiMassesSquared, mPiPiCutMin, mPiPiCutMax);
+  thePairMassFilter.addHypothesis(kKMassesSquared, mKKCutMin, mKKCutMax);
+
   //edm::LogInfo("V0Producer") << "Using " << vtxFitter << " to fit V0 vertices.\n";
   //std::cout << "Using " << vtxFitter << " to fit V0 vertices." << std::endl;
   // FOR DEBUG:
@@ -221,7 +359,7 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   double xVtxError=-999.0;
   double yVtxError=-999.0;
   double zVtxError=-999.0;
-  const reco::VertexCollection vtxCollection = *(theVertexHandle.product());
+  const reco::VertexCollection& vtxCollection = *(theVertexHandle.product());
   reco::VertexCollection::const_iterator vtxPrimary = vtxCollection.begin();
   if(vtxCollection.size()>0 && !vtxPrimary->isFake() && vtxPrimary->tracksSize()>=2)
   {
@@ -244,85 +382,80 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
   }
 
   // Fill vectors of TransientTracks and TrackRefs after applying preselection cuts.
-  for(unsigned int indx = 0; indx < theTrackHandle->size(); indx++) {
-    TrackRef tmpRef( theTrackHandle, indx );
-    bool quality_ok = true;
-    if (qualities.size()!=0) {
-      quality_ok = false;
-      for (unsigned int ndx_ = 0; ndx_ < qualities.size(); ndx_++) {
-	if (tmpRef->quality(qualities[ndx_])){
-	  quality_ok = true;
-	  break;          
-	}
-      }
-    }
-    if( !quality_ok ) continue;
-
-    if( tmpRef->normalizedChi2() < tkChi2Cut &&
-        tmpRef->numberOfValidHits() >= tkNhitsCut &&
-        tmpRef->pt() > tkPtCut ) {
-//      TransientTrack tmpTk( *tmpRef, &(*bFieldHandle), globTkGeomHandle );
-      TransientTrack tmpTk( *tmpRef, magField );
-
-      math::XYZPoint bestvtx(xVtx,yVtx,zVtx);
-      double dzvtx = tmpRef->dz(bestvtx);
-      double dxyvtx = tmpRef->dxy(bestvtx);      
-      double dzerror = sqrt(tmpRef->dzError()*tmpRef->dzError()+zVtxError*zVtxError);
-      double dxyerror = sqrt(tmpRef->d0Error()*tmpRef->d0Error()+xVtxError*yVtxError);
-
-      double dauLongImpactSig = dzvtx/dzerror;
-      double dauTransImpactSig = dxyvtx/dxyerror;
-//std::cout<<dxyvtx<<" "<<dauTransImpactSig<<"; "<<dzvtx<<" "<<dauLongImpactSig<<std::endl;
-      if( fabs(dauTransImpactSig) > dauTransImpactSigCut && fabs(dauLongImpactSig) > dauLongImpactSigCut ) {
-        theTrackRefs.push_back( tmpRef );
-        theTransTracks.push_back( tmpTk );
-      }
-    }
+  std::vector<TrackRef> theSelectedTracks;
+  thePreselection.select(iEvent, theTrackHandle, math::XYZPoint(xVtx,yVtx,zVtx), math::XYZPoint(xVtxError,yVtxError,zVtxError), theSelectedTracks);
+  for(unsigned int indx = 0; indx < theSelectedTracks.size(); indx++) {
+    const TrackRef& tmpRef = theSelectedTracks[indx];
+    TransientTrack tmpTk( *tmpRef, magField );
+    theTrackRefs.push_back( tmpRef );
+    theTransTracks.push_back( tmpTk );
   }
 
-  // Loop over tracks and vertex good charged track pairs
-  for(unsigned int trdx1 = 0; trdx1 < theTrackRefs.size(); trdx1++) {
+  // the cascade stages veto the daughters of their V0 by track key
+  theDaughterVeto.reset(theTrackHandle.id(), theTrackHandle->size());
 
-    for(unsigned int trdx2 = trdx1 + 1; trdx2 < theTrackRefs.size(); trdx2++) {
+  // Impact-point states are evaluated once per track and shared by all pairs
+  theTrackStates.clear();
+  theTrackStates.reserve(theTransTracks.size());
+  for(unsigned int indx = 0; indx < theTransTracks.size(); indx++) {
+    theTrackStates.push_back(theTransTracks[indx]);
+  }
 
-      //This vector holds the pair of oppositely-charged tracks to be vertexed
-      std::vector<TransientTrack> transTracks;
+  // Loop over opposite-sign track pairs. Tracks are sorted by momentum
+  //  within each charge, so only the negative tracks that can pass the
+  //  mPiPi and mKK windows with the positive one are visited.
+  thePairEnumerator.fill(theTrackRefs);
+  const std::vector<unsigned int>& posTrackIndices = thePairEnumerator.positives();
+  const std::vector<unsigned int>& negTrackIndices = thePairEnumerator.negatives();
 
-      TrackRef positiveTrackRef;
-      TrackRef negativeTrackRef;
-      TransientTrack* posTransTkPtr = 0;
-      TransientTrack* negTransTkPtr = 0;
-
-      // Look at the two tracks we're looping over.  If they're oppositely
-      //  charged, load them into the hypothesized positive and negative tracks
-      //  and references to be sent to the KalmanVertexFitter
-      if(theTrackRefs[trdx1]->charge() < 0. && 
-	 theTrackRefs[trdx2]->charge() > 0.) {
-	negativeTrackRef = theTrackRefs[trdx1];
-	positiveTrackRef = theTrackRefs[trdx2];
-	negTransTkPtr = &theTransTracks[trdx1];
-	posTransTkPtr = &theTransTracks[trdx2];
-      }
-      else if(theTrackRefs[trdx1]->charge() > 0. &&
-	      theTrackRefs[trdx2]->charge() < 0.) {
-	negativeTrackRef = theTrackRefs[trdx2];
-	positiveTrackRef = theTrackRefs[trdx1];
-	negTransTkPtr = &theTransTracks[trdx2];
-	posTransTkPtr = &theTransTracks[trdx1];
-      }
-      // If they're not 2 oppositely charged tracks, loop back to the
-      //  beginning and try the next pair.
-      else continue;
+  // Transverse circles of the tracks, in the order of the sorted lists, to
+  //  drop the pairs failing tkDCACut or the 120 cm radius before ClosestApproachInRPhi
+  thePosCircles.fill(theTrackStates, posTrackIndices);
+  theNegCircles.fill(theTrackStates, negTrackIndices);
 
-      // Fill the vector of TransientTracks to send to KVF
-      transTracks.push_back(*posTransTkPtr);
-      transTracks.push_back(*negTransTkPtr);
+  // Candidates built around one positive track. Everything shared between
+  //  the calls is only read, so the positive tracks can be processed as
+  //  independent tasks.
+  auto fitPositiveTrack = [&](unsigned int ipos, PairCandidates& theCandidates) {
 
-      // Trajectory states to calculate DCA for the 2 tracks
-      FreeTrajectoryState posState = posTransTkPtr->impactPointTSCP().theState();
-      FreeTrajectoryState negState = negTransTkPtr->impactPointTSCP().theState();
+    std::vector<unsigned int> negSurvivors;
+    std::vector<PairSeed> pairSeeds;
+    MassHypothesisFilter<2> pairMassFilter(thePairMassFilter);
+
+    // concurrent tasks fit with their own copy of the vertex fitter
+    std::unique_ptr<PairVertexFitter> taskVertexFitter;
+    if( parallelPairLoop && theVertexFitter ) taskVertexFitter.reset(theVertexFitter->clone());
+    const PairVertexFitter* pairVertexFitter = taskVertexFitter ? taskVertexFitter.get() : theVertexFitter.get();
+
+    const unsigned int posIndx = posTrackIndices[ipos];
+    if( !theTrackStates.isValid(posIndx) ) return;
+
+    const HelixDCAPrefilter::Circle& posCircle = thePosCircles.circleAt(ipos);
+    if( !HelixDCAPrefilter::insideRadius(posCircle, tkDCACut, 120.) ) return;
+
+    const std::pair<unsigned int, unsigned int> negRange = thePairEnumerator.partners(ipos);
+    negSurvivors.clear();
+    theNegCircles.select(posCircle, negRange.first, negRange.second, tkDCACut, 120., negSurvivors);
+
+    const TransientTrack& posTransTk = theTransTracks[posIndx];
+    const FreeTrajectoryState& posState = theTrackStates.state(posIndx);
+
+    // First pass: closest approach and momenta at the crossing point for
+    //  all partners, the mass windows are then tested on the whole block
+    pairSeeds.clear();
+    pairMassFilter.clear();
 
-      if( !posTransTkPtr->impactPointTSCP().isValid() || !negTransTkPtr->impactPointTSCP().isValid() ) continue;
+    for(unsigned int isurv = 0; isurv < negSurvivors.size(); isurv++) {
+
+      const unsigned int ineg = negSurvivors[isurv];
+      const unsigned int negIndx = negTrackIndices[ineg];
+
+      if( !theTrackStates.isValid(negIndx) ) continue;
+
+      const TransientTrack& negTransTk = theTransTracks[negIndx];
+
+      // Trajectory states to calculate DCA for the 2 tracks
+      const FreeTrajectoryState& negState = theTrackStates.state(negIndx);
 
       // Measure distance between tracks at their closest approach
       ClosestApproachInRPhi cApp;
@@ -336,51 +469,44 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
           || std::abs(cxPt.z()) > 300.) continue;
 
       // Get trajectory states for the tracks at POCA for later cuts
-      TrajectoryStateClosestToPoint posTSCP = 
-	posTransTkPtr->trajectoryStateClosestToPoint( cxPt );
-      TrajectoryStateClosestToPoint negTSCP =
-	negTransTkPtr->trajectoryStateClosestToPoint( cxPt );
+      PairSeed seed;
+      seed.negIndx = negIndx;
+      seed.posTSCP = posTransTk.trajectoryStateClosestToPoint( cxPt );
+      seed.negTSCP = negTransTk.trajectoryStateClosestToPoint( cxPt );
 
-      if( !posTSCP.isValid() || !negTSCP.isValid() ) continue;
+      if( !seed.posTSCP.isValid() || !seed.negTSCP.isValid() ) continue;
 
-      double totalE = sqrt( posTSCP.momentum().mag2() + piMassSquared ) +
-	              sqrt( negTSCP.momentum().mag2() + piMassSquared );
-      double totalESq = totalE*totalE;
-      double totalPSq =
-	( posTSCP.momentum() + negTSCP.momentum() ).mag2();
-      double mass = sqrt( totalESq - totalPSq);
+      const GlobalVector dauMomenta[2] = {seed.posTSCP.momentum(), seed.negTSCP.momentum()};
+      pairMassFilter.push_back(dauMomenta);
+      pairSeeds.push_back(seed);
+    }
 
-      if( mass > mPiPiCutMax || mass < mPiPiCutMin ) continue;
+    // pipi and KK mass windows
+    const std::vector<char>& passMass = pairMassFilter.select();
 
-      totalE = sqrt( posTSCP.momentum().mag2() + kaonMassSquared ) +
-               sqrt( negTSCP.momentum().mag2() + kaonMassSquared );
-      totalESq = totalE*totalE;
-      totalPSq =
-        ( posTSCP.momentum() + negTSCP.momentum() ).mag2();
-      mass = sqrt( totalESq - totalPSq);
+    for(unsigned int iseed = 0; iseed < pairSeeds.size(); iseed++) {
 
-      if( mass > mKKCutMax || mass < mKKCutMin ) continue;
+      if( !passMass[iseed] ) continue;
 
-      // Create the vertex fitter object and vertex the tracks
-      TransientVertex theRecoVertex;
-      if(vtxFitter == std::string("KalmanVertexFitter")) {
-	KalmanVertexFitter theKalmanFitter(useRefTrax == 0 ? false : true);
-        theRecoVertex = theKalmanFitter.vertex(transTracks);
-/*
-        vector<RefCountedKinematicParticle> dauParticles;
-        dauParticles.push_back(pFactory.particle(,piMass,chi,ndf,piMass_sigma));
-        dauParticles.push_back(pFactory.particle(protonTT,protonMass,chi,ndf,protonMass_sigma));
+      const unsigned int negIndx = pairSeeds[iseed].negIndx;
+      const TrajectoryStateClosestToPoint& posTSCP = pairSeeds[iseed].posTSCP;
+      const TrajectoryStateClosestToPoint& negTSCP = pairSeeds[iseed].negTSCP;
 
-        KinematicParticleVertexFitter theKalmanFitter;
-        RefCountedKinematicTree theRecoVertex;
-        theRecoVertex = theKalmanFitter.fit(dauParticles);
-*/
-      }
-      else if (vtxFitter == std::string("AdaptiveVertexFitter")) {
-	useRefTrax = false;
-	AdaptiveVertexFitter theAdaptiveFitter;
-	theRecoVertex = theAdaptiveFitter.vertex(transTracks);
-      }
+      TrackRef positiveTrackRef = theTrackRefs[posIndx];
+      TrackRef negativeTrackRef = theTrackRefs[negIndx];
+      TransientTrack* posTransTkPtr = &theTransTracks[posIndx];
+      TransientTrack* negTransTkPtr = &theTransTracks[negIndx];
+
+      //This vector holds the pair of oppositely-charged tracks to be vertexed
+      std::vector<TransientTrack> transTracks;
+
+      // Fill the vector of TransientTracks to send to KVF
+      transTracks.push_back(*posTransTkPtr);
+      transTracks.push_back(*negTransTkPtr);
+
+      // Vertex the tracks
+      TransientVertex theRecoVertex;
+      if( pairVertexFitter ) theRecoVertex = pairVertexFitter->vertex(transTracks, posTSCP, negTSCP);
     
       // Create reco::Vertex object for use in creating the Candidate
       reco::Vertex theVtx;
@@ -470,7 +596,7 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
       std::auto_ptr<TrajectoryStateClosestToPoint> trajPlus;
       std::auto_ptr<TrajectoryStateClosestToPoint> trajMins;
 
-      if( useRefTrax && refittedTrax.size() > 1 ) {
+      if( pairVertexFitter && pairVertexFitter->providesRefittedTracks() && refittedTrax.size() > 1 ) {
 	// Need an iterator over the refitted tracks for below
 	std::vector<TransientTrack>::iterator traxIter = refittedTrax.begin(),
 	  traxEnd = refittedTrax.end();
@@ -519,7 +645,6 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
       double protonE = sqrt( positiveP.mag2() + protonMassSquared );
       double antiProtonE = sqrt( negativeP.mag2() + protonMassSquared );
       double d0ETot = kaonMinusE + piPlusE;
-      double d0BarETot = kaonPlusE + piMinusE;
       double kShortETot = piPlusE + piMinusE;
       double phiETot = kaonPlusE + kaonMinusE;
       double lambdaEtot = protonE + piMinusE;
@@ -543,48 +668,12 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
       const Particle::LorentzVector d0P4(totalP.x(),
                                              totalP.y(), totalP.z(),
                                              d0ETot);
-      const Particle::LorentzVector d0BarP4(totalP.x(),
-                                             totalP.y(), totalP.z(),
-                                             d0BarETot);
 
       Particle::Point vtx(theVtx.x(), theVtx.y(), theVtx.z());
       const Vertex::CovarianceMatrix vtxCov(theVtx.covariance());
       double vtxChi2(theVtx.chi2());
       double vtxNdof(theVtx.ndof());
 
-      // Create the VertexCompositeCandidate object that will be stored in the Event
-      VertexCompositeCandidate* theKshort = 0;
-      VertexCompositeCandidate* thePhi = 0;
-      VertexCompositeCandidate* theLambda = 0;
-      VertexCompositeCandidate* theLambdaBar = 0;
-      VertexCompositeCandidate* theD0 = 0;
-      VertexCompositeCandidate* theD0Bar = 0;
-
-      if( doKshorts ) {
-	theKshort = new VertexCompositeCandidate(0, kShortP4, vtx, vtxCov, vtxChi2, vtxNdof);
-      }
-
-      if( doPhis ) {
-        thePhi = new VertexCompositeCandidate(0, phiP4, vtx, vtxCov, vtxChi2, vtxNdof);
-      }
-
-      if( doLambdas ) {
-	if( positiveP.mag() > negativeP.mag() ) {
-	  theLambda = 
-	    new VertexCompositeCandidate(0, lambdaP4, vtx, vtxCov, vtxChi2, vtxNdof);
-	}
-	else {
-	  theLambdaBar = 
-	    new VertexCompositeCandidate(0, lambdaBarP4, vtx, vtxCov, vtxChi2, vtxNdof);
-	}
-      }
-      if( doD0s ) {
-          theD0 =
-            new VertexCompositeCandidate(0, d0P4, vtx, vtxCov, vtxChi2, vtxNdof);
-          theD0Bar =
-            new VertexCompositeCandidate(0, d0BarP4, vtx, vtxCov, vtxChi2, vtxNdof);
-      }
-
       // Create daughter candidates for the VertexCompositeCandidates
       RecoChargedCandidate 
 	thePiPlusCand(1, Particle::LorentzVector(positiveP.x(), 
@@ -622,84 +711,52 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
 						      antiProtonE), vtx);
       theAntiProtonCand.setTrack(negativeTrackRef);
 
-      AddFourMomenta addp4;
-      // Store the daughter Candidates in the VertexCompositeCandidates 
+      // Build the VertexCompositeCandidates in place in the collections
       //    if they pass mass cuts
       if( doKshorts ) {
-	theKshort->addDaughter(thePiPlusCand);
-	theKshort->addDaughter(thePiMinusCand);
-	theKshort->setPdgId(310);
-	addp4.set( *theKshort );
-	if( theKshort->mass() < kShortMass + kShortMassCut &&
-	    theKshort->mass() > kShortMass - kShortMassCut ) {
-	  theKshorts.push_back( *theKshort );
-	}
+	appendCandidate(theCandidates.kshorts, kShortP4, vtx, vtxCov, vtxChi2, vtxNdof,
+			thePiPlusCand, thePiMinusCand, 310, kShortMass, kShortMassCut);
       }
-      
+
       if( doPhis ) {
-        thePhi->addDaughter(theKaonPlusCand);
-        thePhi->addDaughter(theKaonMinusCand);
-        thePhi->setPdgId(333);
-        addp4.set( *thePhi );
-        if( thePhi->mass() < phiMass + phiMassCut &&
-            thePhi->mass() > phiMass - phiMassCut ) {
-          thePhis.push_back( *thePhi );
-        }
+        appendCandidate(theCandidates.phis, phiP4, vtx, vtxCov, vtxChi2, vtxNdof,
+                        theKaonPlusCand, theKaonMinusCand, 333, phiMass, phiMassCut);
       }
 
-      if( doLambdas && theLambda ) {
-	theLambda->addDaughter(theProtonCand);
-	theLambda->addDaughter(thePiMinusCand);
-	theLambda->setPdgId(3122);
-	addp4.set( *theLambda );
-	if( theLambda->mass() < lambdaMass + lambdaMassCut &&
-	    theLambda->mass() > lambdaMass - lambdaMassCut ) {
-	  theLambdas.push_back( *theLambda );
+      if( doLambdas ) {
+	if( positiveP.mag() > negativeP.mag() ) {
+	  appendCandidate(theCandidates.lambdas, lambdaP4, vtx, vtxCov, vtxChi2, vtxNdof,
+			  theProtonCand, thePiMinusCand, 3122, lambdaMass, lambdaMassCut);
 	}
-      }
-      else if ( doLambdas && theLambdaBar ) {
-	theLambdaBar->addDaughter(theAntiProtonCand);
-	theLambdaBar->addDaughter(thePiPlusCand);
-	theLambdaBar->setPdgId(-3122);
-	addp4.set( *theLambdaBar );
-	if( theLambdaBar->mass() < lambdaMass + lambdaMassCut &&
-	    theLambdaBar->mass() > lambdaMass - lambdaMassCut ) {
-	  theLambdas.push_back( *theLambdaBar );
+	else {
+	  appendCandidate(theCandidates.lambdas, lambdaBarP4, vtx, vtxCov, vtxChi2, vtxNdof,
+			  theAntiProtonCand, thePiPlusCand, -3122, lambdaMass, lambdaMassCut);
 	}
       }
 
-      if( doD0s && theD0 ) {
-//std::cout<<"do D0"<<std::endl;
-        theD0->addDaughter(theKaonMinusCand);
-        theD0->addDaughter(thePiPlusCand);
-        theD0->setPdgId(421);
-        addp4.set( *theD0 );
-//std::cout<<"D0 mass="<<theD0->mass()<<std::endl;
-        if( theD0->mass() < d0Mass + d0MassCut &&
-            theD0->mass() > d0Mass - d0MassCut ) {
-          theD0s.push_back( *theD0 );
-//std::cout<<"add D0"<<std::endl;
-        }
-      }
-      else if ( doD0s && theD0Bar ) {
-        theD0Bar->addDaughter(theKaonPlusCand);
-        theD0Bar->addDaughter(thePiMinusCand);
-        theD0Bar->setPdgId(-421);
-        addp4.set( *theD0Bar );
-        if( theD0Bar->mass() < d0Mass + d0MassCut &&
-            theD0Bar->mass() > d0Mass - d0MassCut ) {
-          theD0s.push_back( *theD0Bar );
-        }
+      if( doD0s ) {
+        appendCandidate(theCandidates.d0s, d0P4, vtx, vtxCov, vtxChi2, vtxNdof,
+                        theKaonMinusCand, thePiPlusCand, 421, d0Mass, d0MassCut);
       }
-
-      if(theKshort) delete theKshort;
-      if(thePhi) delete thePhi;
-      if(theLambda) delete theLambda;
-      if(theLambdaBar) delete theLambdaBar;
-      if(theD0) delete theD0;
-      if(theD0Bar) delete theD0Bar;
-      theKshort = thePhi = theLambda = theLambdaBar = theD0 = theD0Bar = 0;
     }
+  };
+
+  if( parallelPairLoop ) {
+    // one buffer per positive track, merged in track order so that the
+    //  collections are identical to the serial ones
+    std::vector<PairCandidates> theBuffers(posTrackIndices.size());
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, posTrackIndices.size()),
+                      [&](const tbb::blocked_range<unsigned int>& range) {
+                        for(unsigned int ipos = range.begin(); ipos != range.end(); ipos++) {
+                          fitPositiveTrack(ipos, theBuffers[ipos]);
+                        }
+                      });
+    for(unsigned int ipos = 0; ipos < theBuffers.size(); ipos++) appendPairCandidates(theBuffers[ipos]);
+  }
+  else {
+    PairCandidates theBuffer;
+    for(unsigned int ipos = 0; ipos < posTrackIndices.size(); ipos++) fitPositiveTrack(ipos, theBuffer);
+    appendPairCandidates(theBuffer);
   }
 
   if((doLambdaCToKsPs || doDSToKsKs || doDPMs) && theKshorts.size() > 0) 
@@ -720,11 +777,13 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
                               (theKshort.daughter(1))) );
 
       for(unsigned int j = 0; j < v0daughters.size(); ++j) theDaughterTracks.push_back(v0daughters[j].track());
+      theDaughterVeto.setDaughters(theDaughterTracks);
 
       vector<TransientTrack> tracksForKalmanFit;
       for (unsigned int ndx = 0; ndx < theDaughterTracks.size(); ndx++) {
           tracksForKalmanFit.push_back(TransientTrack(theDaughterTracks[ndx], &(*bFieldHandle)));
       }
+      ConstrainedV0Fit ksFit;
 
       for(unsigned int trdx = 0; trdx < theTrackRefs.size(); trdx++) {
 
@@ -771,57 +830,24 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
          double dauTransImpactSig = dxyvtx/dxyerror;
          if( fabs(dauTransImpactSig) < batDauTransImpactSigCut || fabs(dauLongImpactSig) < batDauLongImpactSigCut ) continue;
 
-         bool match = false;
-
-         for(unsigned int j = 0; j < theDaughterTracks.size(); ++j) {
-           if (theTrackRefs[trdx]->charge() == theDaughterTracks[j]->charge() &&
-               theTrackRefs[trdx]->momentum() == theDaughterTracks[j]->momentum() ) match = true;
-           if (match) break;
-         }
-         if (match) continue; // Track is already used in making the V0
+         if ( theDaughterVeto.isDaughter(theTrackRefs[trdx]) ) continue; // Track is already used in making the V0
 
-         TransientTrack pion1TT(theDaughterTracks[0], &(*bFieldHandle) );
-         TransientTrack pion2TT(theDaughterTracks[1], &(*bFieldHandle) );
          TransientTrack batPionTT(theTrackRefs[trdx], &(*bFieldHandle) );
 
          if (!batPionTT.isValid()) continue;
-         if (!pion1TT.isValid()) continue;
-         if (!pion2TT.isValid()) continue;
+
+         if (!ksFit.fit(tracksForKalmanFit[0],piMass,piMass_sigma,
+                        tracksForKalmanFit[1],piMass,piMass_sigma,
+                        kShortMass,kShortMass_sigma)) continue;
+
+         const RefCountedKinematicVertex& ks_vFit_vertex = ksFit.vertex();
 
          //Creating a KinematicParticleFactory
          KinematicParticleFactoryFromTransientTrack pFactory;
 
          float chi = 0.;
          float ndf = 0.;
-         vector<RefCountedKinematicParticle> ksParticles;
-         ksParticles.push_back(pFactory.particle(pion1TT,piMass,chi,ndf,piMass_sigma));
-         ksParticles.push_back(pFactory.particle(pion2TT,piMass,chi,ndf,piMass_sigma));
-
          KinematicParticleVertexFitter fitter;
-         RefCountedKinematicTree ksVertexFitTree;
-         ksVertexFitTree = fitter.fit(ksParticles);
-         if (!ksVertexFitTree->isValid()) continue;
-
-         ksVertexFitTree->movePointerToTheTop();
-
-         RefCountedKinematicParticle ks_vFit = ksVertexFitTree->currentParticle();
-         RefCountedKinematicVertex ks_vFit_vertex = ksVertexFitTree->currentDecayVertex();
-
-         ksVertexFitTree->movePointerToTheFirstChild();
-         RefCountedKinematicParticle ksPi1 = ksVertexFitTree->currentParticle();
-         ksVertexFitTree->movePointerToTheNextChild();
-         RefCountedKinematicParticle ksPi2 = ksVertexFitTree->currentParticle();
-
-         KinematicParticleFitter csFitterKs;
-         KinematicConstraint * ks_c = new MassKinematicConstraint(kShortMass,kShortMass_sigma);
-
-         ksVertexFitTree->movePointerToTheTop();
-         ksVertexFitTree = csFitterKs.fit(ks_c,ksVertexFitTree);
-         if (!ksVertexFitTree->isValid()) continue;
-         ksVertexFitTree->movePointerToTheTop();
-         RefCountedKinematicParticle ks_vFit_withMC = ksVertexFitTree->currentParticle();
-
-         if (!ks_vFit_withMC->currentState().isValid()) continue;
 /*
          float batPionMass = protonMass;
          float batPionMass_sigma = protonMass_sigma;
@@ -847,7 +873,7 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
          vector<RefCountedKinematicParticle> xiFitParticles;
 
          xiFitParticles.push_back(pFactory.particle(batPionTT,batPionMass,chi,ndf,batPionMass_sigma));
-         xiFitParticles.push_back(ks_vFit_withMC);
+         xiFitParticles.push_back(ksFit.particle());
 
          RefCountedKinematicTree xiFitTree = fitter.fit(xiFitParticles);
          if (!xiFitTree->isValid()) continue;
@@ -936,51 +962,26 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
                                                  batPionTotalP.y(), batPionTotalP.z(),
                                                  batPionTotalE), xiVtx);
          PionCand.setTrack(theTrackRefs[trdx]);
-         AddFourMomenta addp4;
 
          if(doLambdaCToKsPs)
          {
-           VertexCompositeCandidate* theLambdaCToKsP = 0;
-           theLambdaCToKsP = new VertexCompositeCandidate(0, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof);
-           theLambdaCToKsP->addDaughter(theKshort);
-           theLambdaCToKsP->addDaughter(PionCand);
-           if(theTrackRefs[trdx]->charge()>0) { theLambdaCToKsP->setPdgId(4122); theLambdaCToKsP->setCharge(1); }
-           else { theLambdaCToKsP->setPdgId(-4122); theLambdaCToKsP->setCharge(-1); }
-           addp4.set( *theLambdaCToKsP );
-           if( theLambdaCToKsP->mass() < lambdaCMass + lambdaCMassCut &&
-               theLambdaCToKsP->mass() > lambdaCMass - lambdaCMassCut ) theLambdaCToKsPs.push_back( *theLambdaCToKsP );
-           if(theLambdaCToKsP) delete theLambdaCToKsP;
-           theLambdaCToKsP = 0;
+           appendCandidate(theLambdaCToKsPs, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof,
+                           theKshort, PionCand, theTrackRefs[trdx]->charge()>0 ? 4122 : -4122,
+                           lambdaCMass, lambdaCMassCut);
          }
 
          if(doDSToKsKs)
          {
-           VertexCompositeCandidate* theDSToKsK = 0;
-           theDSToKsK = new VertexCompositeCandidate(0, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof);
-           theDSToKsK->addDaughter(theKshort);
-           theDSToKsK->addDaughter(PionCand);
-           if(theTrackRefs[trdx]->charge()>0) { theDSToKsK->setPdgId(431); theDSToKsK->setCharge(1); }
-           else { theDSToKsK->setPdgId(-431); theDSToKsK->setCharge(-1); }
-           addp4.set( *theDSToKsK );
-           if( theDSToKsK->mass() < dsMass + dsMassCut &&
-               theDSToKsK->mass() > dsMass - dsMassCut ) theDSToKsKs.push_back( *theDSToKsK );
-           if(theDSToKsK) delete theDSToKsK;
-           theDSToKsK = 0;
+           appendCandidate(theDSToKsKs, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof,
+                           theKshort, PionCand, theTrackRefs[trdx]->charge()>0 ? 431 : -431,
+                           dsMass, dsMassCut);
          }
 
          if(doDPMs)
          {
-           VertexCompositeCandidate* theDPM = 0;
-           theDPM = new VertexCompositeCandidate(0, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof);
-           theDPM->addDaughter(theKshort);
-           theDPM->addDaughter(PionCand);
-           if(theTrackRefs[trdx]->charge()>0) { theDPM->setPdgId(411); theDPM->setCharge(1); }
-           else { theDPM->setPdgId(-431); theDPM->setCharge(-1); }
-           addp4.set( *theDPM );
-           if( theDPM->mass() < dpmMass + dpmMassCut &&
-               theDPM->mass() > dpmMass - dpmMassCut ) theDPMs.push_back( *theDPM );
-           if(theDPM) delete theDPM;
-           theDPM = 0;
+           appendCandidate(theDPMs, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof,
+                           theKshort, PionCand, theTrackRefs[trdx]->charge()>0 ? 411 : -431,
+                           dpmMass, dpmMassCut);
          }
 
       }
@@ -1007,11 +1008,13 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
 				 (thePhi.daughter(1))) );
 
 	for(unsigned int j = 0; j < v0daughters.size(); ++j) theDaughterTracks.push_back(v0daughters[j].track());
+	theDaughterVeto.setDaughters(theDaughterTracks);
 
 	vector<TransientTrack> tracksForKalmanFit;
 	for (unsigned int ndx = 0; ndx < theDaughterTracks.size(); ndx++) {
           tracksForKalmanFit.push_back(TransientTrack(theDaughterTracks[ndx], &(*bFieldHandle)));
 	}
+	ConstrainedV0Fit phiFit;
 
 	for(unsigned int trdx = 0; trdx < theTrackRefs.size(); trdx++) {
 
@@ -1028,57 +1031,24 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
 	  double dauTransImpactSig = dxyvtx/dxyerror;
 	  if( fabs(dauTransImpactSig) < batDauTransImpactSigCut || fabs(dauLongImpactSig) < batDauLongImpactSigCut ) continue;
 
-	  bool match = false;
+	  if ( theDaughterVeto.isDaughter(theTrackRefs[trdx]) ) continue; // Track is already used in making the V0
 
-	  for(unsigned int j = 0; j < theDaughterTracks.size(); ++j) {
-	    if (theTrackRefs[trdx]->charge() == theDaughterTracks[j]->charge() &&
-		theTrackRefs[trdx]->momentum() == theDaughterTracks[j]->momentum() ) match = true;
-	    if (match) break;
-	  }
-	  if (match) continue; // Track is already used in making the V0
-
-	  TransientTrack pion1TT(theDaughterTracks[0], &(*bFieldHandle) );
-	  TransientTrack pion2TT(theDaughterTracks[1], &(*bFieldHandle) );
 	  TransientTrack batPionTT(theTrackRefs[trdx], &(*bFieldHandle) );
 
 	  if (!batPionTT.isValid()) continue;
-	  if (!pion1TT.isValid()) continue;
-	  if (!pion2TT.isValid()) continue;
+
+	  if (!phiFit.fit(tracksForKalmanFit[0],kaonMass,kaonMass_sigma,
+	                  tracksForKalmanFit[1],kaonMass,kaonMass_sigma,
+	                  phiMass,phiMass_sigma)) continue;
+
+	  const RefCountedKinematicVertex& phi_vFit_vertex = phiFit.vertex();
 
 	  //Creating a KinematicParticleFactory
 	  KinematicParticleFactoryFromTransientTrack pFactory;
 
 	  float chi = 0.;
 	  float ndf = 0.;
-	  vector<RefCountedKinematicParticle> phiParticles;
-	  phiParticles.push_back(pFactory.particle(pion1TT,kaonMass,chi,ndf,kaonMass_sigma));
-	  phiParticles.push_back(pFactory.particle(pion2TT,kaonMass,chi,ndf,kaonMass_sigma));
-
 	  KinematicParticleVertexFitter fitter;
-	  RefCountedKinematicTree phiVertexFitTree;
-	  phiVertexFitTree = fitter.fit(phiParticles);
-	  if (!phiVertexFitTree->isValid()) continue;
-
-	  phiVertexFitTree->movePointerToTheTop();
-
-	  RefCountedKinematicParticle phi_vFit = phiVertexFitTree->currentParticle();
-	  RefCountedKinematicVertex phi_vFit_vertex = phiVertexFitTree->currentDecayVertex();
-
-	  phiVertexFitTree->movePointerToTheFirstChild();
-	  RefCountedKinematicParticle phiPi1 = phiVertexFitTree->currentParticle();
-	  phiVertexFitTree->movePointerToTheNextChild();
-	  RefCountedKinematicParticle phiPi2 = phiVertexFitTree->currentParticle();
-
-	  KinematicParticleFitter csFitterPhi;
-	  KinematicConstraint * phi_c = new MassKinematicConstraint(phiMass,phiMass_sigma);
-
-	  phiVertexFitTree->movePointerToTheTop();
-	  phiVertexFitTree = csFitterPhi.fit(phi_c,phiVertexFitTree);
-	  if (!phiVertexFitTree->isValid()) continue;
-	  phiVertexFitTree->movePointerToTheTop();
-	  RefCountedKinematicParticle phi_vFit_withMC = phiVertexFitTree->currentParticle();
-
-	  if (!phi_vFit_withMC->currentState().isValid()) continue;
 
 	  float batPionMass = piMass;
 	  float batPionMass_sigma = piMass_sigma;
@@ -1086,7 +1056,7 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
          vector<RefCountedKinematicParticle> xiFitParticles;
 
          xiFitParticles.push_back(pFactory.particle(batPionTT,batPionMass,chi,ndf,batPionMass_sigma));
-         xiFitParticles.push_back(phi_vFit_withMC);
+         xiFitParticles.push_back(phiFit.particle());
 
          RefCountedKinematicTree xiFitTree = fitter.fit(xiFitParticles);
          if (!xiFitTree->isValid()) continue;
@@ -1173,21 +1143,12 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
                                                  batPionTotalP.y(), batPionTotalP.z(),
                                                  batPionTotalE), xiVtx);
          PionCand.setTrack(theTrackRefs[trdx]);
-         AddFourMomenta addp4;
 
          if(doDSToPhiPis)
          {
-           VertexCompositeCandidate* theDSToPhiPi = 0;
-           theDSToPhiPi = new VertexCompositeCandidate(0, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof);
-           theDSToPhiPi->addDaughter(thePhi);
-           theDSToPhiPi->addDaughter(PionCand);
-           if(theTrackRefs[trdx]->charge()>0) { theDSToPhiPi->setPdgId(431); theDSToPhiPi->setCharge(1); }
-           else { theDSToPhiPi->setPdgId(-431); theDSToPhiPi->setCharge(-1); }
-           addp4.set( *theDSToPhiPi );
-           if( theDSToPhiPi->mass() < dsMass + dsMassCut &&
-               theDSToPhiPi->mass() > dsMass - dsMassCut ) theDSToPhiPis.push_back( *theDSToPhiPi );
-           if(theDSToPhiPi) delete theDSToPhiPi;
-           theDSToPhiPi = 0;
+           appendCandidate(theDSToPhiPis, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof,
+                           thePhi, PionCand, theTrackRefs[trdx]->charge()>0 ? 431 : -431,
+                           dsMass, dsMassCut);
          }
       }
     }
@@ -1228,11 +1189,13 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
        for(unsigned int j = 0; j < v0daughters.size(); ++j) {
          theDaughterTracks.push_back(v0daughters[j].track());
        }
+       theDaughterVeto.setDaughters(theDaughterTracks);
 
        vector<TransientTrack> tracksForKalmanFit;
        for (unsigned int ndx = 0; ndx < theDaughterTracks.size(); ndx++) {
            tracksForKalmanFit.push_back(TransientTrack(theDaughterTracks[ndx], &(*bFieldHandle)));
        }
+       ConstrainedV0Fit lambdaFit;
 
        vector<double> lamDauMasses;
        if (lamIsParticle && tracksForKalmanFit[0].charge() > 0) {
@@ -1262,66 +1225,27 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
          double dauTransImpactSig = dxyvtx/dxyerror;
          if( fabs(dauTransImpactSig) < batDauTransImpactSigCut || fabs(dauLongImpactSig) < batDauLongImpactSigCut ) continue;
 
-         bool match = false;
-         // check if the pion is used in any v0 candidate in the collection and flag it
-         for(unsigned int j = 0; j < theDaughterTracks.size(); ++j) {
-           if (theTrackRefs[trdx]->charge() == theDaughterTracks[j]->charge() &&
-               theTrackRefs[trdx]->momentum() == theDaughterTracks[j]->momentum() ) match = true;
-           if (match) break;
-         }
-         if (match) continue; // Track is already used in making the V0
+         if ( theDaughterVeto.isDaughter(theTrackRefs[trdx]) ) continue; // Track is already used in making the V0
 
          // check if pion is in *any* good V0
          // Placeholder
        
-         TransientTrack pionTT(theDaughterTracks[0], &(*bFieldHandle) );
-         TransientTrack protonTT(theDaughterTracks[1], &(*bFieldHandle) );
          TransientTrack batPionTT(theTrackRefs[trdx], &(*bFieldHandle) );
 
          if (!batPionTT.isValid()) continue;
-         if (!pionTT.isValid()) continue;
-         if (!protonTT.isValid()) continue;
+
+         if (!lambdaFit.fit(tracksForKalmanFit[0],piMass,piMass_sigma,
+                            tracksForKalmanFit[1],protonMass,protonMass_sigma,
+                            lambdaMass,lambdaMass_sigma)) continue;
+
+         const RefCountedKinematicVertex& lambda_vFit_vertex = lambdaFit.vertex();
 
          //Creating a KinematicParticleFactory
          KinematicParticleFactoryFromTransientTrack pFactory;
 
-         //initial chi2 and ndf before kinematic fits.
          float chi = 0.;
          float ndf = 0.;
-         vector<RefCountedKinematicParticle> lambdaParticles;
-         lambdaParticles.push_back(pFactory.particle(pionTT,piMass,chi,ndf,piMass_sigma));
-         lambdaParticles.push_back(pFactory.particle(protonTT,protonMass,chi,ndf,protonMass_sigma));
-
          KinematicParticleVertexFitter fitter;
-         RefCountedKinematicTree lambdaVertexFitTree;
-         lambdaVertexFitTree = fitter.fit(lambdaParticles);
-         if (!lambdaVertexFitTree->isValid()) continue;
-  
-         lambdaVertexFitTree->movePointerToTheTop();
-
-         RefCountedKinematicParticle lambda_vFit = lambdaVertexFitTree->currentParticle();
-         RefCountedKinematicVertex lambda_vFit_vertex = lambdaVertexFitTree->currentDecayVertex();
-
-         lambdaVertexFitTree->movePointerToTheFirstChild();
-         RefCountedKinematicParticle lambdaPi1 = lambdaVertexFitTree->currentParticle();
-         lambdaVertexFitTree->movePointerToTheNextChild();
-         RefCountedKinematicParticle lambdaPi2 = lambdaVertexFitTree->currentParticle();
-
-//         KinematicParameters lambdaPiKP = lambdaPi1->currentState().kinematicParameters();
-//         KinematicParameters lambdaPKP  = lambdaPi2->currentState().kinematicParameters();
-
-         // now apply Lambda mass constraint
-         KinematicParticleFitter csFitterLambda;
-         KinematicConstraint * lam_c = new MassKinematicConstraint(lambdaMass,lambdaMass_sigma);
-         // add mass constraint to the lambda fit to do a constrained fit:  
-
-         lambdaVertexFitTree->movePointerToTheTop();
-         lambdaVertexFitTree = csFitterLambda.fit(lam_c,lambdaVertexFitTree);
-         if (!lambdaVertexFitTree->isValid()) continue;
-         lambdaVertexFitTree->movePointerToTheTop();
-         RefCountedKinematicParticle lambda_vFit_withMC = lambdaVertexFitTree->currentParticle();
-
-         if (!lambda_vFit_withMC->currentState().isValid()) continue; 
 
          if(doXis || doLambdaCToLamPis)
          {
@@ -1340,7 +1264,7 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
            vector<RefCountedKinematicParticle> xiFitParticles;
 
            xiFitParticles.push_back(pFactory.particle(batPionTT,piMass,chi,ndf,piMass_sigma));
-           xiFitParticles.push_back(lambda_vFit_withMC);
+           xiFitParticles.push_back(lambdaFit.particle());
 
            //fit Xi 
            RefCountedKinematicTree xiFitTree = fitter.fit(xiFitParticles);
@@ -1439,42 +1363,24 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
                                                    batPionTotalE), xiVtx);
            PionCand.setTrack(theTrackRefs[trdx]);
 
-           AddFourMomenta addp4;
-           // Store the daughter Candidates in the VertexCompositeCandidates 
-           // if they pass mass cuts
+           // Build the candidates in place if they pass mass cuts
            if(doXis)
            {
              if(lamIsParticle && PionCand.charge()>0) continue;
              if(!lamIsParticle && PionCand.charge()<0) continue;
 
-             VertexCompositeCandidate* theXi = 0;
-             theXi = new VertexCompositeCandidate(0, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof);
-             theXi->addDaughter(theLambda);
-             theXi->addDaughter(PionCand);
-             if(lamIsParticle) { theXi->setPdgId(3312); theXi->setCharge(-1); }
-             else { theXi->setPdgId(-3312); theXi->setCharge(1); }
-             addp4.set( *theXi );
-             if( theXi->mass() < xiMass + xiMassCut &&
-                 theXi->mass() > xiMass - xiMassCut ) theXis.push_back( *theXi );
-             if(theXi) delete theXi;
-             theXi = 0;
+             appendCandidate(theXis, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof,
+                             theLambda, PionCand, lamIsParticle ? 3312 : -3312,
+                             xiMass, xiMassCut);
            }
            if(doLambdaCToLamPis)
            {
              if(lamIsParticle && PionCand.charge()<0) continue;
              if(!lamIsParticle && PionCand.charge()>0) continue;
 
-             VertexCompositeCandidate* theLambdaCToLamPi = 0;
-             theLambdaCToLamPi = new VertexCompositeCandidate(0, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof);
-             theLambdaCToLamPi->addDaughter(theLambda);
-             theLambdaCToLamPi->addDaughter(PionCand);
-             if(lamIsParticle) { theLambdaCToLamPi->setPdgId(4122); theLambdaCToLamPi->setCharge(1); }
-             else { theLambdaCToLamPi->setPdgId(-4122); theLambdaCToLamPi->setCharge(-1); } 
-             addp4.set( *theLambdaCToLamPi );
-             if( theLambdaCToLamPi->mass() < lambdaCMass + lambdaCMassCut &&
-                 theLambdaCToLamPi->mass() > lambdaCMass - lambdaCMassCut ) theLambdaCToLamPis.push_back( *theLambdaCToLamPi );
-             if(theLambdaCToLamPi) delete theLambdaCToLamPi;
-             theLambdaCToLamPi = 0;
+             appendCandidate(theLambdaCToLamPis, xiP4, xiVtx, xiVtxCov, xiVtxChi2, xiVtxNdof,
+                             theLambda, PionCand, lamIsParticle ? 4122 : -4122,
+                             lambdaCMass, lambdaCMassCut);
            }
         }
 
@@ -1486,7 +1392,7 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
            vector<RefCountedKinematicParticle> omegaFitParticles;
 
            omegaFitParticles.push_back(pFactory.particle(batPionTT,kaonMass,chi,ndf,kaonMass_sigma));
-           omegaFitParticles.push_back(lambda_vFit_withMC);
+           omegaFitParticles.push_back(lambdaFit.particle());
 
            //fit Omega 
            RefCountedKinematicTree omegaFitTree = fitter.fit(omegaFitParticles);
@@ -1579,33 +1485,33 @@ void V0Fitter::fitAll(const edm::Event& iEvent, const edm::EventSetup& iSetup) {
                cos(omegaV0Angle) < xiCollinCut
            ) continue;
 
-           // Cuts finished, Create the VertexCompositeCandidate object for Omega that will be stored in the Event
-           VertexCompositeCandidate* theOmega = 0;
-           theOmega = new VertexCompositeCandidate(0, omegaP4, omegaVtx, omegaVtxCov, omegaVtxChi2, omegaVtxNdof);
-
            RecoChargedCandidate PionCand(theTrackRefs[trdx]->charge(), Particle::LorentzVector(batPionTotalP.x(),
                                                    batPionTotalP.y(), batPionTotalP.z(),
                                                    batPionTotalE), omegaVtx);
            PionCand.setTrack(theTrackRefs[trdx]);
 
-           AddFourMomenta addp4;
-           // Store the daughter Candidates in the VertexCompositeCandidates 
-           // if they pass mass cuts
-           theOmega->addDaughter(theLambda);
-           theOmega->addDaughter(PionCand);
-           if(lamIsParticle) { theOmega->setPdgId(3334);  theOmega->setCharge(-2); }
-           else { theOmega->setPdgId(-3334);  theOmega->setCharge(2); } 
-           addp4.set( *theOmega );
-           if( theOmega->mass() < omegaMass + omegaMassCut &&
-               theOmega->mass() > omegaMass - omegaMassCut ) theOmegas.push_back( *theOmega );
-           if(theOmega) delete theOmega;
-           theOmega = 0;
+           // Cuts finished, build the Omega in place if it passes the mass cut
+           appendCandidate(theOmegas, omegaP4, omegaVtx, omegaVtxCov, omegaVtxChi2, omegaVtxNdof,
+                           theLambda, PionCand, lamIsParticle ? 3334 : -3334,
+                           omegaMass, omegaMassCut);
 	 }
       }
     }
   }
 }
 
+void V0Fitter::appendPairCandidates(PairCandidates& theCandidates) {
+  theKshorts.insert(theKshorts.end(), std::make_move_iterator(theCandidates.kshorts.begin()),
+                    std::make_move_iterator(theCandidates.kshorts.end()));
+  thePhis.insert(thePhis.end(), std::make_move_iterator(theCandidates.phis.begin()),
+                 std::make_move_iterator(theCandidates.phis.end()));
+  theLambdas.insert(theLambdas.end(), std::make_move_iterator(theCandidates.lambdas.begin()),
+                    std::make_move_iterator(theCandidates.lambdas.end()));
+  theD0s.insert(theD0s.end(), std::make_move_iterator(theCandidates.d0s.begin()),
+                std::make_move_iterator(theCandidates.d0s.end()));
+  theCandidates = PairCandidates();
+}
+
 // Get methods
 const reco::VertexCompositeCandidateCollection& V0Fitter::getKshorts() const {
   return theKshorts;
@@ -1651,6 +1557,50 @@ const reco::VertexCompositeCandidateCollection& V0Fitter::getLambdaCToKsP() cons
   return theLambdaCToKsPs;
 }
 
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseKshorts() {
+  return releaseCollection(theKshorts);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releasePhis() {
+  return releaseCollection(thePhis);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseLambdas() {
+  return releaseCollection(theLambdas);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseXis() {
+  return releaseCollection(theXis);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseOmegas() {
+  return releaseCollection(theOmegas);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseD0() {
+  return releaseCollection(theD0s);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseDSToKsK() {
+  return releaseCollection(theDSToKsKs);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseDSToPhiPi() {
+  return releaseCollection(theDSToPhiPis);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseDPM() {
+  return releaseCollection(theDPMs);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseLambdaCToLamPi() {
+  return releaseCollection(theLambdaCToLamPis);
+}
+
+std::unique_ptr<reco::VertexCompositeCandidateCollection> V0Fitter::releaseLambdaCToKsP() {
+  return releaseCollection(theLambdaCToKsPs);
+}
+
 void V0Fitter::resetAll() {
   theKshorts.clear();
   thePhis.clear();
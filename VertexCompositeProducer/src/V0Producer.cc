@@ -66,84 +66,18 @@ void V0Producer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup) {
 
    theVees.fitAll(iEvent, iSetup);
 
-   // Create unique_ptr for each collection to be stored in the Event
-   std::unique_ptr< reco::VertexCompositeCandidateCollection > 
-     kShortCandidates( new reco::VertexCompositeCandidateCollection );
-   kShortCandidates->reserve( theVees.getKshorts().size() ); 
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     phiCandidates( new reco::VertexCompositeCandidateCollection );
-   phiCandidates->reserve( theVees.getPhis().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     lambdaCandidates( new reco::VertexCompositeCandidateCollection );
-   lambdaCandidates->reserve( theVees.getLambdas().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     xiCandidates( new reco::VertexCompositeCandidateCollection );
-   xiCandidates->reserve( theVees.getXis().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     omegaCandidates( new reco::VertexCompositeCandidateCollection );
-   omegaCandidates->reserve( theVees.getOmegas().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     d0Candidates( new reco::VertexCompositeCandidateCollection );
-   d0Candidates->reserve( theVees.getD0().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     dsCandidates1( new reco::VertexCompositeCandidateCollection );
-   dsCandidates1->reserve( theVees.getDSToKsK().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     dsCandidates2( new reco::VertexCompositeCandidateCollection );
-   dsCandidates2->reserve( theVees.getDSToPhiPi().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     dpmCandidates( new reco::VertexCompositeCandidateCollection );
-   dpmCandidates->reserve( theVees.getDPM().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     lambdaCCandidates1( new reco::VertexCompositeCandidateCollection );
-   lambdaCCandidates1->reserve( theVees.getLambdaCToLamPi().size() );
-
-   std::unique_ptr< reco::VertexCompositeCandidateCollection >
-     lambdaCCandidates2( new reco::VertexCompositeCandidateCollection );
-   lambdaCCandidates2->reserve( theVees.getLambdaCToKsP().size() );
-
-   std::copy( theVees.getKshorts().begin(),
-	      theVees.getKshorts().end(),
-	      std::back_inserter(*kShortCandidates) );
-   std::copy( theVees.getPhis().begin(),
-              theVees.getPhis().end(),
-              std::back_inserter(*phiCandidates) );
-   std::copy( theVees.getLambdas().begin(),
-	      theVees.getLambdas().end(),
-	      std::back_inserter(*lambdaCandidates) );
-   std::copy( theVees.getXis().begin(),
-              theVees.getXis().end(),
-              std::back_inserter(*xiCandidates) );
-   std::copy( theVees.getOmegas().begin(),
-              theVees.getOmegas().end(),
-              std::back_inserter(*omegaCandidates) );
-   std::copy( theVees.getD0().begin(),
-              theVees.getD0().end(),
-              std::back_inserter(*d0Candidates) );
-   std::copy( theVees.getDSToKsK().begin(),
-              theVees.getDSToKsK().end(),
-              std::back_inserter(*dsCandidates1) );
-   std::copy( theVees.getDSToPhiPi().begin(),
-              theVees.getDSToPhiPi().end(),
-              std::back_inserter(*dsCandidates2) );
-   std::copy( theVees.getDPM().begin(),
-              theVees.getDPM().end(),
-              std::back_inserter(*dpmCandidates) );
-   std::copy( theVees.getLambdaCToLamPi().begin(),
-              theVees.getLambdaCToLamPi().end(),
-              std::back_inserter(*lambdaCCandidates1) );
-   std::copy( theVees.getLambdaCToKsP().begin(),
-              theVees.getLambdaCToKsP().end(),
-              std::back_inserter(*lambdaCCandidates2) );
+   // Move each collection out of the fitter to be stored in the Event
+   auto kShortCandidates = theVees.releaseKshorts();
+   auto phiCandidates = theVees.releasePhis();
+   auto lambdaCandidates = theVees.releaseLambdas();
+   auto xiCandidates = theVees.releaseXis();
+   auto omegaCandidates = theVees.releaseOmegas();
+   auto d0Candidates = theVees.releaseD0();
+   auto dsCandidates1 = theVees.releaseDSToKsK();
+   auto dsCandidates2 = theVees.releaseDSToPhiPi();
+   auto dpmCandidates = theVees.releaseDPM();
+   auto lambdaCCandidates1 = theVees.releaseLambdaCToLamPi();
+   auto lambdaCCandidates2 = theVees.releaseLambdaCToKsP();
 
    // Write the collections to the Event
    iEvent.put( std::move(kShortCandidates), std::string("Kshort") );
@@ -0,0 +1,72 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+//
+// Program:    testDaughterTrackVeto
+//
+/**\file testDaughterTrackVeto.cc VertexCompositeAnalysis/VertexCompositeProducer/test/testDaughterTrackVeto.cc
+
+ Description: checks that DaughterTrackVeto matches daughters by key in the
+              collection given to reset() and by charge and momentum across
+              collections
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/DaughterTrackVeto.h"
+
+#include "DataFormats/Common/interface/TestHandle.h"
+#include "DataFormats/Provenance/interface/ProductID.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+  reco::Track track(double px, int charge) {
+    return reco::Track(1., 10., reco::Track::Point(0., 0., 0.), reco::Track::Vector(px, 1., 1.),
+                       charge, reco::Track::CovarianceMatrix());
+  }
+}
+
+int main() {
+
+  reco::TrackCollection tracks, others;
+  tracks.push_back(track(1., 1));
+  tracks.push_back(track(2., -1));
+  tracks.push_back(track(3., 1));
+  const reco::TrackCollection copies = tracks;
+  others.push_back(track(1., -1));
+
+  const edm::TestHandle<reco::TrackCollection> tracksHandle(&tracks, edm::ProductID(1, 1));
+  const edm::TestHandle<reco::TrackCollection> copiesHandle(&copies, edm::ProductID(1, 2));
+  const edm::TestHandle<reco::TrackCollection> othersHandle(&others, edm::ProductID(1, 3));
+
+  DaughterTrackVeto veto;
+  veto.reset(tracksHandle.id(), tracks.size());
+
+  // track 0 by key, track 1 through its copy
+  std::vector<reco::TrackRef> daughters;
+  daughters.push_back(reco::TrackRef(tracksHandle, 0));
+  daughters.push_back(reco::TrackRef(copiesHandle, 1));
+  veto.setDaughters(daughters);
+
+  bool pass = veto.isDaughter(reco::TrackRef(tracksHandle, 0)) &&
+              veto.isDaughter(reco::TrackRef(tracksHandle, 1)) &&
+              !veto.isDaughter(reco::TrackRef(tracksHandle, 2)) &&
+              veto.isDaughter(reco::TrackRef(copiesHandle, 0)) &&
+              !veto.isDaughter(reco::TrackRef(copiesHandle, 2)) &&
+              !veto.isDaughter(reco::TrackRef(othersHandle, 0));
+
+  // the marks of the previous parent are cleared
+  daughters.assign(1, reco::TrackRef(tracksHandle, 2));
+  veto.setDaughters(daughters);
+
+  pass = pass && !veto.isDaughter(reco::TrackRef(tracksHandle, 0)) &&
+                 !veto.isDaughter(reco::TrackRef(tracksHandle, 1)) &&
+                 veto.isDaughter(reco::TrackRef(tracksHandle, 2));
+
+  if( !pass ) std::cerr << "DaughterTrackVeto vetoed the wrong tracks" << std::endl;
+  return pass ? 0 : 1;
+}
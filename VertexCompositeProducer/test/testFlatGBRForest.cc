@@ -0,0 +1,99 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+//
+// Program:    testFlatGBRForest
+//
+/**\file testFlatGBRForest.cc VertexCompositeAnalysis/VertexCompositeProducer/test/testFlatGBRForest.cc
+
+ Description: checks that FlatGBRForest, and CompiledGBRForest where one is
+              registered, give exactly the GBRForest values on the forests
+              shipped in data/, including inputs equal to a cut value
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/FlatGBRForest.h"
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/CompiledGBRForest.h"
+
+#include "FWCore/ParameterSet/interface/FileInPath.h"
+#include "CondFormats/EgammaObjects/interface/GBRForest.h"
+
+#include "TFile.h"
+#include "TKey.h"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  const unsigned int nCandidates = 10000;
+
+  const char* forestFiles[] = {
+    "VertexCompositeAnalysis/VertexCompositeProducer/data/GBRForestfile.root",
+    "VertexCompositeAnalysis/VertexCompositeProducer/data/GBRForestfile_BDT_PromptD0InpPb_default_HLT185_WS.root",
+    "VertexCompositeAnalysis/VertexCompositeProducer/data/GBRForestfile_BDT_NonPromptD0InpPb_default_HLT185_WS.root"
+  };
+}
+
+int main() {
+
+  unsigned int nForests = 0;
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+
+  for(unsigned int ifile = 0; ifile < sizeof(forestFiles)/sizeof(forestFiles[0]); ifile++) {
+    const std::string fileName = forestFiles[ifile];
+    TFile gbrfile(edm::FileInPath(fileName).fullPath().c_str(),"READ");
+
+    TIter next(gbrfile.GetListOfKeys());
+    while( TKey* key = (TKey*)next() ) {
+      if( std::string(key->GetClassName()) != "GBRForest" ) continue;
+      const std::string label = key->GetName();
+      GBRForest* forest = (GBRForest*)key->ReadObj();
+      if( !forest ) continue;
+      nForests++;
+
+      const FlatGBRForest flatForest(*forest);
+      const unsigned int nVars = flatForest.nVars() ? flatForest.nVars() : 1;
+
+      // half of the inputs are cut values of the forest, the others are
+      //  spread around them
+      std::vector<float> cuts;
+      const std::vector<GBRTree>& trees = forest->Trees();
+      for(unsigned int itree = 0; itree < trees.size(); itree++) {
+        cuts.insert(cuts.end(), trees[itree].CutVals().begin(), trees[itree].CutVals().end());
+      }
+      std::vector<float> inputs(nCandidates*nVars);
+      for(unsigned int k = 0; k < inputs.size(); k++) {
+        const float cut = cuts.empty() ? 0.f : cuts[unsigned(uniform(gen)*cuts.size()) % cuts.size()];
+        inputs[k] = uniform(gen) < 0.5 ? cut : cut*(0.5 + uniform(gen)) + (uniform(gen) - 0.5);
+      }
+
+      GBRFeatureMatrix features(nVars);
+      for(unsigned int k = 0; k < nCandidates; k++) features.push_back(&inputs[k*nVars]);
+
+      std::vector<double> batch, compiled;
+      flatForest.GetClassifier(features, batch);
+      const CompiledGBRForest compiledForest = CompiledGBRForest::find(fileName, label);
+      if( compiledForest.isValid() ) compiledForest.GetClassifier(features, compiled);
+
+      for(unsigned int k = 0; k < nCandidates; k++) {
+        const double reference = forest->GetClassifier(&inputs[k*nVars]);
+        if( flatForest.GetClassifier(&inputs[k*nVars]) != reference || batch[k] != reference ||
+            ( compiledForest.isValid() && compiled[k] != reference ) ) {
+          std::cerr << fileName << " " << label << ": candidate " << k << " differs from GBRForest" << std::endl;
+          return 1;
+        }
+      }
+      delete forest;
+    }
+  }
+
+  if( nForests == 0 ) {
+    std::cerr << "No GBRForest found" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+// -*- C++ -*-
+//
+// Package:    VertexCompositeProducer
+//
+// Program:    testHelixDCAPrefilter
+//
+/**\file testHelixDCAPrefilter.cc VertexCompositeAnalysis/VertexCompositeProducer/test/testHelixDCAPrefilter.cc
+
+ Description: checks that HelixDCAPrefilter keeps every helix pair which
+              passes the DCA and 120 cm radius cuts with ClosestApproachInRPhi
+*/
+//
+//
+
+#include "VertexCompositeAnalysis/VertexCompositeProducer/interface/HelixDCAPrefilter.h"
+
+#include "MagneticField/UniformEngine/interface/UniformMagneticField.h"
+#include "TrackingTools/PatternTools/interface/ClosestApproachInRPhi.h"
+#include "TrackingTools/TrajectoryParametrization/interface/GlobalTrajectoryParameters.h"
+#include "TrackingTools/TrajectoryState/interface/FreeTrajectoryState.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+
+  const double maxRadius = 120.;
+  const double dcaCut = 1.;
+
+  UniformMagneticField field(3.8);
+  std::mt19937 gen(20190421);
+  std::uniform_real_distribution<double> pt(0.1, 10.);
+  std::uniform_real_distribution<double> phi(-M_PI, M_PI);
+  std::uniform_real_distribution<double> eta(-2.4, 2.4);
+  std::uniform_real_distribution<double> radius(0., 200.);
+  std::normal_distribution<double> smear(0., 1.);
+
+  for(unsigned int ipair = 0; ipair < 100000; ipair++) {
+    // two helices from nearby points, as for a displaced vertex
+    const double r = radius(gen);
+    const double vphi = phi(gen);
+    std::vector<FreeTrajectoryState> states;
+    for(unsigned int itrk = 0; itrk < 2; itrk++) {
+      const GlobalPoint vertex(r*cos(vphi) + smear(gen), r*sin(vphi) + smear(gen), smear(gen));
+      const double thePt = pt(gen);
+      const double thePhi = phi(gen);
+      const GlobalVector mom(thePt*cos(thePhi), thePt*sin(thePhi), thePt*sinh(eta(gen)));
+      states.push_back( FreeTrajectoryState( GlobalTrajectoryParameters(vertex, mom, itrk ? -1 : 1, &field) ) );
+    }
+
+    ClosestApproachInRPhi cApp;
+    cApp.calculate(states[0], states[1]);
+    if( !cApp.status() || fabs(cApp.distance()) > dcaCut || cApp.crossingPoint().perp() > maxRadius ) continue;
+
+    const HelixDCAPrefilter::Circle circle1 = HelixDCAPrefilter::circle(states[0]);
+    const HelixDCAPrefilter::Circle circle2 = HelixDCAPrefilter::circle(states[1]);
+
+    HelixDCAPrefilter partner;
+    partner.fill(std::vector<HelixDCAPrefilter::Circle>(1, circle2));
+    std::vector<unsigned int> survivors;
+    partner.select(circle1, 0, 1, dcaCut, maxRadius, survivors);
+
+    if( survivors.empty() ||
+        !HelixDCAPrefilter::insideRadius(circle1, dcaCut, maxRadius) ||
+        !HelixDCAPrefilter::insideRadius(circle2, dcaCut, maxRadius) ) {
+      std::cerr << "pair " << ipair << " with distance " << cApp.distance() << " and crossing point radius "
+                << cApp.crossingPoint().perp() << " dropped" << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}